@@ -14,6 +14,7 @@
 **/
 
 #include <HAL/DrmControllerRegistersStrategyInterface.hpp>
+#include "trace.h"
 
 // name space usage
 using namespace DrmControllerLibrary;
@@ -295,6 +296,8 @@ unsigned int DrmControllerRegistersStrategyInterface::waitStatusRegister(const u
 *   \throw DrmControllerUnsupportedFeature whenever the feature is not supported. DrmControllerUnsupportedFeature::what() should be called to get the exception description.
 **/
 unsigned int DrmControllerRegistersStrategyInterface::waitStatusRegister(const unsigned int &timeout, const unsigned int &bitPosition, const unsigned int &mask, const unsigned int &expected, unsigned int &actual) const {
+  DRM_TRACE_SCOPE(wait_status_register);
+  DRM_TRACE_ARGS(wait_status_register_start, bitPosition, expected, timeout);
   unsigned int errorCode = writeRegistersPageRegister();
   if (errorCode != mDrmApi_NO_ERROR) return errorCode;
   // get current time
@@ -311,10 +314,13 @@ unsigned int DrmControllerRegistersStrategyInterface::waitStatusRegister(const u
     // get time duration
     timeTaken = (unsigned int)(currentTimePoint.tv_sec - startTimePoint.tv_sec)*DRM_CONTROLLER_NUMBER_OF_MICRO_SECONDS_IN_ONE_SECOND +
                               (currentTimePoint.tv_usec - startTimePoint.tv_usec);
+    DRM_TRACE_ARGS(wait_status_register_poll, actual, timeTaken);
     // check timeout reached
-    if (timeout > 0 && timeTaken > timeout)
+    if (timeout > 0 && timeTaken > timeout) {
+      DRM_TRACE_ARGS(wait_status_register_timeout, actual, timeTaken);
       // return timeout error
       return mDrmApi_HARDWARE_TIMEOUT_ERROR;
+    }
     // exit loop when expected status is reached
     if (actual == expected)
       break;
@@ -352,6 +358,8 @@ unsigned int DrmControllerRegistersStrategyInterface::readErrorRegister(const un
 *   \return Returns mDrmApi_NO_ERROR if no error, mDrmApi_HARDWARE_TIMEOUT_ERROR if a timeout occured, errors from read/write register functions otherwize.
 **/
 unsigned int DrmControllerRegistersStrategyInterface::waitErrorRegister(const unsigned int &timeout, const unsigned int &position, const unsigned int &mask, const unsigned char &expected, unsigned char &actual) const {
+  DRM_TRACE_SCOPE(wait_error_register);
+  DRM_TRACE_ARGS(wait_error_register_start, position, expected, timeout);
   unsigned int errorCode = writeRegistersPageRegister();
   if (errorCode != mDrmApi_NO_ERROR) return errorCode;
   // get current time
@@ -368,10 +376,13 @@ unsigned int DrmControllerRegistersStrategyInterface::waitErrorRegister(const un
     // get time duration
     timeTaken = (unsigned int)(currentTimePoint.tv_sec - startTimePoint.tv_sec)*DRM_CONTROLLER_NUMBER_OF_MICRO_SECONDS_IN_ONE_SECOND +
                               (currentTimePoint.tv_usec - startTimePoint.tv_usec);
+    DRM_TRACE_ARGS(wait_error_register_poll, actual, timeTaken);
     // check timeout reached
-    if (timeout > 0 && timeTaken > timeout)
+    if (timeout > 0 && timeTaken > timeout) {
+      DRM_TRACE_ARGS(wait_error_register_timeout, actual, timeTaken);
       // return timeout error
       return mDrmApi_HARDWARE_TIMEOUT_ERROR;
+    }
     // exit loop when expected status is reached
     if (actual == expected)
       break;
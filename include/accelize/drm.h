@@ -21,5 +21,6 @@ limitations under the License.
 */
 
 #include "accelize/drm/drm_manager.h"
+#include "accelize/drm/drm_manager_group.h"
 #include "accelize/drm/version.h"
 #include "accelize/drm/error.h"
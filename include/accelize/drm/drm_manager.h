@@ -62,6 +62,9 @@ private:
     //std::unique_ptr<Impl> pImpl; //!< Internal representation
     Impl* pImpl; //!< Internal representation
 
+    friend class DrmManagerGroup;
+    explicit DrmManager( Impl* impl ); //!< Instantiate a slot of a DrmManagerGroup
+
 public:
 
     /** \brief FPGA read register callback function.
@@ -96,6 +99,14 @@ public:
     */
     typedef std::function<void (const std::string&/*error message*/)> AsynchErrorCallback;
 
+    /** \brief Asynchronous Error executor function.
+        This function is given a task delivering a queued asynchronous error and
+        runs it, for instance by posting it to an application thread pool.
+
+        \param[in] task : Task calling the asynchronous error callback.
+    */
+    typedef std::function<void (std::function<void()>/*task*/)> AsynchErrorExecutor;
+
     DrmManager() = delete; //!< No default constructor
 
     /** \brief Instantiate and initialize a DRM manager.
@@ -227,6 +238,19 @@ public:
     */
     template<typename T> void set( const ParameterKey key_id, const T& value );
 
+    /** \brief Deliver asynchronous errors through an executor.
+
+        By default, queued asynchronous errors are delivered by a dedicated
+        thread. This function makes the next errors delivered through the
+        executor instead, or again by the dedicated thread if executor is empty.
+
+        \warning Asynchronous errors are queued only if the
+        "async_error_queue_size" setting is not 0.
+
+        \param[in] executor : Asynchronous Error executor function.
+    */
+    void setAsynchErrorExecutor( AsynchErrorExecutor executor );
+
 };
 
 }
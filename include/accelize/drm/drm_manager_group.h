@@ -0,0 +1,110 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/** \brief Accelize DRM C++ Library: management of several FPGA slots
+*/
+
+#ifndef _H_ACCELIZE_DRM_MANAGER_GROUP
+#define _H_ACCELIZE_DRM_MANAGER_GROUP
+
+#include <string>
+#include <vector>
+
+#include "accelize/drm/drm_manager.h"
+
+
+//! Accelize interfaces and implementations
+namespace Accelize {
+//! DRM specific interface and implementation
+namespace DRM {
+
+
+/** \brief Manage Accelize DRM of several FPGA slots of a host.
+
+    All slots use the same configuration and credential files. They share the
+    Web service client, so the OAuth2 token and the connections, a single
+    worker thread which tracks the license renewal deadlines of all slots and
+    a pool of at most 4 threads which renew the licenses of all slots.
+*/
+class DRM_EXPORT DrmManagerGroup {
+
+private:
+    class Impl; //!< Internal representation
+    Impl* pImpl; //!< Internal representation
+
+public:
+
+    /** \brief Callback functions of one FPGA slot.
+
+        \see DrmManager::ReadRegisterCallback DrmManager::WriteRegisterCallback
+        DrmManager::AsynchErrorCallback
+    */
+    struct SlotCallbacks {
+        DrmManager::ReadRegisterCallback read_register;     //!< FPGA read register callback function
+        DrmManager::WriteRegisterCallback write_register;   //!< FPGA write register callback function
+        DrmManager::AsynchErrorCallback async_error;        //!< Asynchronous Error handling callback function
+    };
+
+    DrmManagerGroup() = delete; //!< No default constructor
+
+    /** \brief Instantiate and initialize a DRM manager for each slot.
+
+        \param[in] conf_file_path : Path to the DRM configuration JSON file.
+        \param[in] cred_file_path : Path to the user Accelize credential JSON file.
+        \param[in] slots : Callback functions of each slot.
+    */
+    DrmManagerGroup( const std::string& conf_file_path,
+                     const std::string& cred_file_path,
+                     const std::vector<SlotCallbacks>& slots );
+
+    DrmManagerGroup(const DrmManagerGroup&) = delete; //!< Non-copyable
+
+    ~DrmManagerGroup(); //!< Destructor
+
+    /** \brief Return the number of slots.
+    */
+    size_t size() const;
+
+    /** \brief Return the DRM manager of a slot.
+
+        \param[in] index : Index of the slot in the list given to the constructor.
+    */
+    DrmManager& getSlot( const size_t& index );
+
+    /** \brief Activate DRM session of all slots in parallel.
+
+        \see DrmManager::activate
+
+        If a slot fails, the other slots are still activated and the error of
+        the first failing slot is thrown.
+    */
+    void activate( const bool& resume_session_request = false );
+
+    /** \brief Deactivate DRM session of all slots in parallel.
+
+        \see DrmManager::deactivate
+
+        If a slot fails, the other slots are still deactivated and the error of
+        the first failing slot is thrown.
+    */
+    void deactivate( const bool& pause_session_request = false );
+
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_MANAGER_GROUP
@@ -31,12 +31,13 @@ limitations under the License.
     #endif /* __cplusplus */
 
 
+    // The message arguments are evaluated once, the log reuses the formatted message
     #define Throw( errcode, ... ) do {                                          \
         Accelize::DRM::Exception except( errcode, fmt::format( __VA_ARGS__ ) ); \
         if ( errcode != DRM_Exit )                                              \
-            Fatal( __VA_ARGS__ );                                               \
+            Fatal( "{}", except.what() );                                       \
         else                                                                    \
-            Debug( __VA_ARGS__ );                                               \
+            Debug( "{}", except.what() );                                       \
         throw except;                                                           \
     } while(0)
 
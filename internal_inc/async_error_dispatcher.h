@@ -0,0 +1,92 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_ASYNC_ERROR_DISPATCHER
+#define _H_ACCELIZE_DRM_ASYNC_ERROR_DISPATCHER
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "metrics.h"
+#include "thread_settings.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Asynchronous error dispatcher : queues the asynchronous errors so that a slow
+ user callback does not delay the thread reporting them. Errors are delivered
+ by a dedicated thread, or by a default executor given at construction, or by a
+ user executor if one is set. An error identical
+ to one still queued is coalesced with it, and errors are dropped when the
+ queue is full*/
+class AsyncErrorDispatcher {
+
+public:
+    typedef std::function<void (const std::string&)> TCallback;
+    typedef std::function<void (std::function<void()>)> TExecutor;
+
+protected:
+    struct Entry {
+        std::string message;
+        uint64_t repeats;   ///< Number of identical errors coalesced with this one
+    };
+
+    // Shared with the tasks given to the executor, which may outlive the dispatcher
+    struct State {
+        TCallback callback;
+        std::mutex mutex;
+        std::deque<Entry> queue;
+
+        bool deliverOne();
+    };
+
+    std::shared_ptr<State> mState;
+    size_t mMaxSize;
+    Counter& mCoalesced;
+    Counter& mDropped;
+    TExecutor mExecutor;
+    TExecutor mDefaultExecutor;     ///< Replaces the dedicated thread if set
+    std::future<void> mThread;
+    std::condition_variable mCondVar;
+    bool mStopRequest = false;
+
+    void run();
+
+public:
+    AsyncErrorDispatcher( TCallback callback, const size_t& max_size, const ThreadSettings& settings,
+            Counter& coalesced, Counter& dropped, TExecutor default_executor = nullptr );
+    ~AsyncErrorDispatcher();    // Deliver the queued errors from the dispatcher thread before returning
+
+    AsyncErrorDispatcher( const AsyncErrorDispatcher& ) = delete;
+
+    // Deliver the next errors through executor instead of the dispatcher thread: an empty executor
+    // restores the default delivery
+    void setExecutor( TExecutor executor );
+
+    // Queue an error: never blocks on the user callback
+    void push( const std::string& message );
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_ASYNC_ERROR_DISPATCHER
@@ -0,0 +1,53 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_CONFIG_WATCHER
+#define _H_ACCELIZE_DRM_CONFIG_WATCHER
+
+#include <string>
+#include <ctime>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Configuration watcher : tells if a file was written or replaced since the
+ last check. On Linux, inotify events are queued by the kernel so a check is a
+ single non-blocking read; elsewhere the modification time is compared*/
+class ConfigWatcher {
+
+protected:
+    std::string mFilePath;
+    std::string mFileName;      ///< Name of the file in its directory, as reported by inotify
+    int mFd = -1;
+    time_t mModificationTime = 0;
+
+    time_t getModificationTime() const;
+
+public:
+    explicit ConfigWatcher( const std::string& file_path );
+    ~ConfigWatcher();
+
+    ConfigWatcher( const ConfigWatcher& ) = delete;
+
+    // Return true if the file changed since the previous call
+    bool hasChanged();
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_CONFIG_WATCHER
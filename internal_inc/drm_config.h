@@ -0,0 +1,75 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_CONFIG
+#define _H_ACCELIZE_DRM_CONFIG
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <json/json.h>
+
+namespace Accelize {
+namespace DRM {
+
+
+// Web service access, read from the "licensing" section and the credential file
+struct WebServiceConfig {
+    std::string url;
+    std::string token_cache_dir;
+    std::string client_id;
+    std::string client_secret;
+};
+
+
+/*DRM configuration : the configuration file is parsed and validated once, then
+ shared read-only by the DRM managers, their web service clients and threads.
+ The web service part is only required with a web service, so it is read and
+ validated when first used: a node-locked license already installed needs
+ neither the licensing URL nor the credential file*/
+struct DrmConfig {
+    std::string conf_file_path;
+    std::string cred_file_path;
+
+    Json::Value settings;           ///< "settings" section: each component reads and validates its own keys
+
+    std::string udid;               ///< Optional design identifiers
+    std::string board_type;
+
+    bool nodelocked = false;
+    std::string license_dir;        ///< Node-locked license directory
+    uint32_t frequency_mhz = 0;     ///< Initial DRM frequency, floating/metered licenses only
+
+    // Parse and validate the configuration file
+    static std::shared_ptr<const DrmConfig> load( const std::string& conf_file_path,
+            const std::string& cred_file_path );
+
+    // Web service access: the credential file is parsed on the first successful call only
+    const WebServiceConfig& getWebService() const;
+
+    // Return true if both have the same design, licensing and DRM sections
+    bool hasSameLicensing( const DrmConfig& other ) const;
+
+protected:
+    Json::Value mLicensing;         ///< "licensing" section, validated by getWebService
+    mutable std::mutex mMutex;
+    mutable std::unique_ptr<WebServiceConfig> mWebService;
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_CONFIG
@@ -0,0 +1,58 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_EVENT_LOG
+#define _H_ACCELIZE_DRM_EVENT_LOG
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <json/json.h>
+
+#include "log.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Event log : machine-readable stream of the session lifecycle events, one JSON
+ object per line. It has its own rotating file sink, independent of the
+ human-oriented log files and formats.*/
+class EventLog {
+
+protected:
+
+    std::shared_ptr<spdlog::logger> mLogger;
+    std::string mSessionID;
+    mutable std::mutex mMutex;
+
+public:
+    EventLog( const std::string& file_path, const size_t& rotating_size, const size_t& rotating_num );
+    ~EventLog();
+
+    EventLog(const EventLog&) = delete;
+
+    // Session ID added to the next events, empty when no session is running
+    void setSessionID( const std::string& session_id );
+
+    // Write {"time": "<ISO 8601 UTC>", "event": "<event>", "session": "<ID>", <fields>}
+    void write( const std::string& event, const Json::Value& fields = Json::objectValue );
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_EVENT_LOG
@@ -0,0 +1,72 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_HW_SNAPSHOT
+#define _H_ACCELIZE_DRM_HW_SNAPSHOT
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+#include "HAL/DrmControllerTypes.hpp"
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Hardware snapshot : raw content of the DRM Controller register pages, read in
+ one pass with a single page switch per page. The text hardware report is
+ rendered from the snapshot by running the DRM Controller SDK report on it,
+ without any hardware access.*/
+class HwSnapshot {
+
+public:
+    static const std::vector<std::string> cPageNames;      ///< Index is the page number
+
+protected:
+    std::chrono::system_clock::time_point mTime;
+    std::vector<std::vector<uint32_t>> mPages;              ///< Register lines of each page
+
+public:
+    HwSnapshot() = default;
+
+    // Convert a DRM Controller SDK register name to its offset in bytes
+    static uint32_t getRegisterOffset( const std::string& reg_name );
+
+    // Return the number of register lines of each page read by the DRM Controller SDK report
+    static std::vector<uint32_t> getReportLayout(
+            const DrmControllerLibrary::tDrmReadRegisterFunction& read_register,
+            const DrmControllerLibrary::tDrmWriteRegisterFunction& write_register );
+
+    // Read the first layout[page] register lines of each page: the caller must own the DRM Controller
+    void capture( const DrmControllerLibrary::tDrmReadRegisterFunction& read_register,
+            const DrmControllerLibrary::tDrmWriteRegisterFunction& write_register,
+            const std::vector<uint32_t>& layout );
+
+    const std::vector<std::vector<uint32_t>>& getPages() const { return mPages; }
+
+    // Return {"time": "<ISO 8601 UTC>", "pages": {"<page name>": [<register line 0>, ...], ...}}
+    Json::Value toJson() const;
+
+    // Render the DRM Controller SDK hardware report
+    std::string toText() const;
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_HW_SNAPSHOT
@@ -26,10 +26,14 @@ limitations under the License.
 #include <thread>
 #include <mutex>
 
-// SPDLOG_ACTIVE_LEVEL must be declared before the spdlog.h include
+// SPDLOG_ACTIVE_LEVEL must be declared before the spdlog.h include.
+// Messages below this level are compiled out: it is set by the LOG_DEBUG build option
+#ifndef SPDLOG_ACTIVE_LEVEL
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+#endif
 
 #include "spdlog/spdlog.h"
+#include "spdlog/async.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 #include "spdlog/sinks/null_sink.h"
 #include "spdlog/sinks/basic_file_sink.h"       // support for basic file logging
@@ -49,18 +53,33 @@ namespace DRM {
     #endif
 
     extern std::shared_ptr<spdlog::logger> sLogger;
+    extern std::shared_ptr<spdlog::details::thread_pool> sLogThreadPool;   ///< Not null when logging asynchronously
+    extern std::mutex sLogAsyncMutex;       ///< Protects the asynchronous logging state shared by all instances
+    extern uint32_t sLogAsyncUsers;         ///< Number of instances using sLogThreadPool
 
-    #define Debug2(...) SPDLOG_TRACE( __VA_ARGS__ )
+    // Return true if a message of this level would be logged: use it to skip building a costly log content
+    inline bool isLogEnabled( const spdlog::level::level_enum& level ) {
+        return ( level >= SPDLOG_ACTIVE_LEVEL ) && spdlog::default_logger_raw()->should_log( level );
+    }
 
-    #define Debug(...) SPDLOG_DEBUG( __VA_ARGS__ )
+    // The message arguments are only evaluated if the level is enabled, so they must
+    // not have side effects. A level below SPDLOG_ACTIVE_LEVEL is still type-checked but compiled out.
+    #define DRM_LOG_CALL( level, ... ) do {                                    \
+        if ( Accelize::DRM::isLogEnabled( level ) )                             \
+            SPDLOG_LOGGER_CALL( spdlog::default_logger_raw(), level, __VA_ARGS__ ); \
+    } while(0)
 
-    #define Info(...) SPDLOG_INFO( __VA_ARGS__ )
+    #define Debug2(...) DRM_LOG_CALL( spdlog::level::trace, __VA_ARGS__ )
 
-    #define Warning(...) SPDLOG_WARN( __VA_ARGS__ )
+    #define Debug(...) DRM_LOG_CALL( spdlog::level::debug, __VA_ARGS__ )
 
-    #define Error(...) SPDLOG_ERROR( __VA_ARGS__ )
+    #define Info(...) DRM_LOG_CALL( spdlog::level::info, __VA_ARGS__ )
 
-    #define Fatal(...) SPDLOG_CRITICAL( __VA_ARGS__ )
+    #define Warning(...) DRM_LOG_CALL( spdlog::level::warn, __VA_ARGS__ )
+
+    #define Error(...) DRM_LOG_CALL( spdlog::level::err, __VA_ARGS__ )
+
+    #define Fatal(...) DRM_LOG_CALL( spdlog::level::critical, __VA_ARGS__ )
 
 }
 }
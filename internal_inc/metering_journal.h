@@ -0,0 +1,65 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_METERING_JOURNAL
+#define _H_ACCELIZE_DRM_METERING_JOURNAL
+
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Metering journal : durable on-disk queue of license requests waiting to be
+ uploaded to the License Web Service. Each entry is a file written atomically,
+ so that a crash never leaves a partial entry, and is locked while uploaded so
+ that several processes can replay the same journal.*/
+class MeteringJournal {
+
+protected:
+
+    std::string mDirPath;
+
+public:
+    MeteringJournal( const std::string& dir_path );
+
+    MeteringJournal(const MeteringJournal&) = delete;
+
+    const std::string& getDirPath() const { return mDirPath; }
+
+    // Write a new entry and return its file path
+    std::string append( const std::string& request_body, const std::string& session_id ) const;
+
+    // Return the path of pending entries, oldest first
+    std::vector<std::string> list() const;
+
+    // Lock an entry for upload: return a file descriptor to pass to unlock, or -1 if already locked
+    int lock( const std::string& entry_path ) const;
+    void unlock( const int& fd ) const;
+
+    Json::Value read( const std::string& entry_path ) const;
+    void remove( const std::string& entry_path ) const;
+
+    // Keep an entry that can never be uploaded aside for manual inspection
+    void reject( const std::string& entry_path ) const;
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_METERING_JOURNAL
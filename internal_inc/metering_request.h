@@ -0,0 +1,51 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_METERING_REQUEST
+#define _H_ACCELIZE_DRM_METERING_REQUEST
+
+#include <string>
+#include <json/json.h>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Metering request template : the header of the license requests describes the
+ design and does not change during a session. It is serialized once, and each
+ request only appends its own fields to it, without building a JSON object*/
+class MeteringRequestTemplate {
+
+protected:
+    std::string mPrefix;    ///< Serialized header without its closing brace
+    std::string mDna;
+
+public:
+    // Serialize the header: must be called again after any change of the header
+    void setHeader( const Json::Value& header );
+
+    const std::string& getDna() const { return mDna; }
+
+    /* Serialize a request into body: session_id is not added if empty and
+     drm_frequency is not added if 0 */
+    void build( std::string& body, const char* request, const std::string& saas_challenge,
+            const std::string& session_id, const std::string& metering_file, const int32_t& drm_frequency ) const;
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_METERING_REQUEST
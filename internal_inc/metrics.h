@@ -0,0 +1,346 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_METRICS
+#define _H_ACCELIZE_DRM_METRICS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <json/json.h>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Monotonic counter: incrementing is lock-free*/
+class Counter {
+
+protected:
+    std::atomic<uint64_t> mValue{0};
+
+public:
+    Counter() = default;
+    Counter( const Counter& ) = delete;
+
+    void inc( const uint64_t& value = 1 ) { mValue.fetch_add( value, std::memory_order_relaxed ); }
+    uint64_t get() const { return mValue.load( std::memory_order_relaxed ); }
+};
+
+
+/*Histogram with fixed bucket upper bounds: recording a value is lock-free*/
+class Histogram {
+
+protected:
+    std::vector<uint64_t> mBounds;                          ///< Sorted bucket upper bounds
+    std::unique_ptr<std::atomic<uint64_t>[]> mBuckets;      ///< Non cumulative bucket counts, last one is +Inf
+    std::atomic<uint64_t> mCount{0};
+    std::atomic<uint64_t> mSum{0};
+
+public:
+    Histogram( const std::vector<uint64_t>& bounds )
+        : mBounds( bounds ), mBuckets( new std::atomic<uint64_t>[ bounds.size() + 1 ] ) {
+        for( size_t i = 0; i <= mBounds.size(); i++ )
+            mBuckets[i] = 0;
+    }
+
+    Histogram( const Histogram& ) = delete;
+
+    // Bucket bounds from 1 to 10^decades following the 1-2-5 sequence
+    static std::vector<uint64_t> exponentialBounds( const uint32_t& decades ) {
+        std::vector<uint64_t> bounds;
+        uint64_t scale = 1;
+        for( uint32_t d = 0; d < decades; d++ ) {
+            bounds.push_back( scale );
+            bounds.push_back( 2 * scale );
+            bounds.push_back( 5 * scale );
+            scale *= 10;
+        }
+        bounds.push_back( scale );
+        return bounds;
+    }
+
+    void record( const uint64_t& value ) {
+        size_t i = 0;
+        while ( ( i < mBounds.size() ) && ( value > mBounds[i] ) )
+            i++;
+        mBuckets[i].fetch_add( 1, std::memory_order_relaxed );
+        mCount.fetch_add( 1, std::memory_order_relaxed );
+        mSum.fetch_add( value, std::memory_order_relaxed );
+    }
+
+    const std::vector<uint64_t>& getBounds() const { return mBounds; }
+    uint64_t getCount() const { return mCount.load( std::memory_order_relaxed ); }
+    uint64_t getSum() const { return mSum.load( std::memory_order_relaxed ); }
+    uint64_t getBucketCount( const size_t& index ) const { return mBuckets[index].load( std::memory_order_relaxed ); }
+
+    // Return {"count": N, "sum": S, "buckets": {"<bound>": cumulative count, ..., "+Inf": N}}
+    Json::Value toJson() const {
+        Json::Value node;
+        uint64_t cumulative = 0;
+        node["count"] = (Json::UInt64)getCount();
+        node["sum"] = (Json::UInt64)getSum();
+        Json::Value& buckets = node["buckets"];
+        buckets = Json::objectValue;
+        for( size_t i = 0; i < mBounds.size(); i++ ) {
+            cumulative += getBucketCount( i );
+            buckets[ std::to_string( mBounds[i] ) ] = (Json::UInt64)cumulative;
+        }
+        buckets["+Inf"] = (Json::UInt64)( cumulative + getBucketCount( mBounds.size() ) );
+        return node;
+    }
+
+    // Append the histogram samples in Prometheus text format; labels is empty or a list like 'a="x",b="y"'
+    void appendPrometheus( std::string& out, const std::string& name, const std::string& labels = "" ) const {
+        std::string sep = labels.empty() ? "" : ",";
+        uint64_t cumulative = 0;
+        for( size_t i = 0; i < mBounds.size(); i++ ) {
+            cumulative += getBucketCount( i );
+            out += name + "_bucket{" + labels + sep + "le=\"" + std::to_string( mBounds[i] ) + "\"} "
+                    + std::to_string( cumulative ) + "\n";
+        }
+        out += name + "_bucket{" + labels + sep + "le=\"+Inf\"} "
+                + std::to_string( cumulative + getBucketCount( mBounds.size() ) ) + "\n";
+        std::string braces = labels.empty() ? "" : "{" + labels + "}";
+        out += name + "_sum" + braces + " " + std::to_string( getSum() ) + "\n";
+        out += name + "_count" + braces + " " + std::to_string( getCount() ) + "\n";
+    }
+};
+
+
+// Append the HELP and TYPE lines of a metric in Prometheus text format
+inline void appendPrometheusHeader( std::string& out, const std::string& name, const std::string& help,
+        const std::string& type ) {
+    out += "# HELP " + name + " " + help + "\n";
+    out += "# TYPE " + name + " " + type + "\n";
+}
+
+
+/*Metrics registry : references counters and histograms owned by other objects
+ to export them all at once*/
+class MetricsRegistry {
+
+protected:
+    struct Entry {
+        std::string name;
+        std::string help;
+        const Counter* counter;
+        const Histogram* histogram;
+    };
+    std::vector<Entry> mEntries;
+
+public:
+    MetricsRegistry() = default;
+    MetricsRegistry( const MetricsRegistry& ) = delete;
+
+    void add( const std::string& name, const std::string& help, const Counter& counter ) {
+        mEntries.push_back( { name, help, &counter, nullptr } );
+    }
+
+    void add( const std::string& name, const std::string& help, const Histogram& histogram ) {
+        mEntries.push_back( { name, help, nullptr, &histogram } );
+    }
+
+    Json::Value toJson() const {
+        Json::Value node = Json::objectValue;
+        for( const auto& entry: mEntries ) {
+            if ( entry.counter )
+                node[entry.name] = (Json::UInt64)entry.counter->get();
+            else
+                node[entry.name] = entry.histogram->toJson();
+        }
+        return node;
+    }
+
+    void appendPrometheus( std::string& out ) const {
+        for( const auto& entry: mEntries ) {
+            if ( entry.counter ) {
+                appendPrometheusHeader( out, entry.name, entry.help, "counter" );
+                out += entry.name + " " + std::to_string( entry.counter->get() ) + "\n";
+            } else {
+                appendPrometheusHeader( out, entry.name, entry.help, "histogram" );
+                entry.histogram->appendPrometheus( out, entry.name );
+            }
+        }
+    }
+};
+
+
+/*Mutex wrapper measuring the lock contention: the time in microseconds spent waiting for the lock, the
+ time it is held from the outermost lock to the last unlock, the recursion depth and the operation owning it.
+ An uncontended lock costs no clock read for the wait time. Operation names must have a static storage
+ duration, like __func__.*/
+template<class TMutex>
+class TimedMutex {
+
+public:
+    struct OperationStatistics {
+        uint64_t count = 0;         ///< Number of outermost acquisitions
+        uint64_t waitTotal = 0;     ///< in us
+        uint64_t waitMax = 0;       ///< in us
+        uint64_t holdTotal = 0;     ///< in us
+        uint64_t holdMax = 0;       ///< in us
+    };
+
+protected:
+    typedef std::chrono::steady_clock TClock;
+
+    TMutex mMutex;
+    Histogram* mWaitTime = nullptr;
+    Histogram* mHoldTime = nullptr;
+
+    // Owner state: only modified by the thread holding the lock
+    uint32_t mDepth = 0;
+    uint64_t mOwnerWait = 0;
+    TClock::time_point mOwnerLockTime;
+    std::atomic<const char*> mOwner{nullptr};
+    std::atomic<uint32_t> mMaxDepth{0};
+
+    // Operation names are string literals: equal names may have distinct addresses across translation units
+    struct NameLess {
+        bool operator()( const char* a, const char* b ) const { return strcmp( a, b ) < 0; }
+    };
+
+    mutable std::mutex mStatisticsMutex;
+    std::map<const char*, OperationStatistics, NameLess> mOperations;
+
+    void acquired( const char* operation, const uint64_t& wait_us ) {
+        mDepth++;
+        if ( mDepth > mMaxDepth.load( std::memory_order_relaxed ) )
+            mMaxDepth.store( mDepth, std::memory_order_relaxed );
+        if ( mDepth > 1 )
+            // Recursive lock by the owner
+            return;
+        if ( mWaitTime )
+            mWaitTime->record( wait_us );
+        mOwnerWait = wait_us;
+        mOwnerLockTime = TClock::now();
+        mOwner.store( operation, std::memory_order_relaxed );
+    }
+
+public:
+    TimedMutex() = default;
+    TimedMutex( const TimedMutex& ) = delete;
+
+    void setWaitTimeHistogram( Histogram* histogram ) { mWaitTime = histogram; }
+    void setHoldTimeHistogram( Histogram* histogram ) { mHoldTime = histogram; }
+
+    void lock( const char* operation ) {
+        uint64_t wait_us = 0;
+        if ( !mMutex.try_lock() ) {
+            auto start = TClock::now();
+            mMutex.lock();
+            wait_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    TClock::now() - start ).count();
+        }
+        acquired( operation, wait_us );
+    }
+
+    void lock() { lock( "unknown" ); }
+
+    bool try_lock( const char* operation ) {
+        if ( !mMutex.try_lock() )
+            return false;
+        acquired( operation, 0 );
+        return true;
+    }
+
+    bool try_lock() { return try_lock( "unknown" ); }
+
+    void unlock() {
+        if ( --mDepth == 0 ) {
+            uint64_t hold_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    TClock::now() - mOwnerLockTime ).count();
+            const char* operation = mOwner.exchange( nullptr, std::memory_order_relaxed );
+            if ( mHoldTime )
+                mHoldTime->record( hold_us );
+            std::lock_guard<std::mutex> lock( mStatisticsMutex );
+            OperationStatistics& stats = mOperations[operation];
+            stats.count++;
+            stats.waitTotal += mOwnerWait;
+            stats.waitMax = std::max( stats.waitMax, mOwnerWait );
+            stats.holdTotal += hold_us;
+            stats.holdMax = std::max( stats.holdMax, hold_us );
+        }
+        mMutex.unlock();
+    }
+
+    // Operation currently holding the lock, nullptr if the lock is free
+    const char* getOwner() const { return mOwner.load( std::memory_order_relaxed ); }
+
+    uint32_t getMaxRecursionDepth() const { return mMaxDepth.load( std::memory_order_relaxed ); }
+
+    // Statistics per operation sorted by decreasing total hold time
+    std::vector<std::pair<std::string, OperationStatistics>> getTopHolders() const {
+        std::vector<std::pair<std::string, OperationStatistics>> holders;
+        {
+            std::lock_guard<std::mutex> lock( mStatisticsMutex );
+            for( const auto& it: mOperations )
+                holders.emplace_back( it.first, it.second );
+        }
+        std::sort( holders.begin(), holders.end(),
+                []( const std::pair<std::string, OperationStatistics>& a,
+                    const std::pair<std::string, OperationStatistics>& b ) {
+                    return a.second.holdTotal > b.second.holdTotal; } );
+        return holders;
+    }
+
+    // Return {"owner": name or null, "max_recursion_depth": N, "operations": {"<name>": {...}, ...}}
+    Json::Value toJson() const {
+        Json::Value node;
+        const char* owner = getOwner();
+        node["owner"] = owner ? Json::Value( owner ) : Json::Value::null;
+        node["max_recursion_depth"] = getMaxRecursionDepth();
+        Json::Value& operations = node["operations"];
+        operations = Json::objectValue;
+        for( const auto& it: getTopHolders() ) {
+            Json::Value& op = operations[it.first];
+            op["count"] = (Json::UInt64)it.second.count;
+            op["wait_total_us"] = (Json::UInt64)it.second.waitTotal;
+            op["wait_max_us"] = (Json::UInt64)it.second.waitMax;
+            op["hold_total_us"] = (Json::UInt64)it.second.holdTotal;
+            op["hold_max_us"] = (Json::UInt64)it.second.holdMax;
+        }
+        return node;
+    }
+};
+
+
+/*Scoped lock of a TimedMutex naming the owning operation*/
+template<class TMutex>
+class TimedLockGuard {
+
+protected:
+    TimedMutex<TMutex>& mMutex;
+
+public:
+    TimedLockGuard( TimedMutex<TMutex>& mutex, const char* operation ) : mMutex( mutex ) {
+        mMutex.lock( operation );
+    }
+    TimedLockGuard( const TimedLockGuard& ) = delete;
+    ~TimedLockGuard() { mMutex.unlock(); }
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_METRICS
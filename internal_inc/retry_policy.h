@@ -0,0 +1,131 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_RETRY_POLICY
+#define _H_ACCELIZE_DRM_RETRY_POLICY
+
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <memory>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Retry policy : computes the wait duration before the next attempt of a
+ Web Service request*/
+class RetryPolicy {
+
+public:
+
+    typedef std::chrono::steady_clock TClock;
+
+    virtual ~RetryPolicy() = default;
+
+    virtual std::string getName() const = 0;
+
+    /* Return false if no more attempt shall be performed, otherwise set the
+     wait duration before the next attempt.
+     short_period and long_period are the retry periods requested by the caller
+     (long_period is 0 if only short retries are expected) */
+    virtual bool getNextDelay( const uint32_t& attempt, const TClock::duration& time_left,
+            const TClock::duration& short_period, const TClock::duration& long_period,
+            TClock::duration& delay ) = 0;
+
+    static std::unique_ptr<RetryPolicy> create( const std::string& name, const uint32_t& max_attempts );
+};
+
+
+/*Fixed retry policy : legacy behavior, retry every long period until the time
+ left is lower than the long period, then every short period*/
+class FixedRetryPolicy: public RetryPolicy {
+
+protected:
+    uint32_t mMaxAttempts;
+
+public:
+    FixedRetryPolicy( const uint32_t& max_attempts = 0 ): mMaxAttempts( max_attempts ) {}
+
+    std::string getName() const override { return "fixed"; }
+
+    bool getNextDelay( const uint32_t& attempt, const TClock::duration& time_left,
+            const TClock::duration& short_period, const TClock::duration& long_period,
+            TClock::duration& delay ) override;
+};
+
+
+/*Exponential backoff with full jitter : the wait duration is randomly picked
+ between short_period / 10 and min(long_period, short_period * 2^(attempt-1)) so
+ that boards sharing the same service do not retry in lockstep. The lower bound
+ prevents an immediate retry during an outage*/
+class ExponentialBackoffRetryPolicy: public RetryPolicy {
+
+protected:
+    uint32_t mMaxAttempts;
+    std::mt19937_64 mRandomGenerator;
+
+public:
+    ExponentialBackoffRetryPolicy( const uint32_t& max_attempts = 0 );
+
+    std::string getName() const override { return "exponential"; }
+
+    bool getNextDelay( const uint32_t& attempt, const TClock::duration& time_left,
+            const TClock::duration& short_period, const TClock::duration& long_period,
+            TClock::duration& delay ) override;
+};
+
+
+/*Circuit breaker : after a number of consecutive failures the Web Service is
+ considered down and requests fail fast until a cool-down period elapsed. Then a
+ single probe request is let through to check if the service has recovered*/
+class CircuitBreaker {
+
+public:
+
+    typedef std::chrono::steady_clock TClock;
+
+    enum class eState: uint8_t {CLOSED=0, OPEN, HALF_OPEN};
+
+protected:
+    mutable std::mutex mMutex;
+    uint32_t mThreshold;             ///< Number of consecutive failures opening the circuit, 0 to disable
+    TClock::duration mCooldown;      ///< Duration during which the circuit stays open
+    uint32_t mFailureCount = 0;
+    eState mState = eState::CLOSED;
+    TClock::time_point mOpenUntil;
+
+public:
+    CircuitBreaker( const uint32_t& threshold = 0, const uint32_t& cooldown_s = 30 );
+
+    void configure( const uint32_t& threshold, const uint32_t& cooldown_s );
+    bool isEnabled() const { return mThreshold != 0; }
+
+    // Return true if a request may be sent now, else set the time when the next probe is allowed
+    bool allowRequest( TClock::time_point& retry_time );
+    void recordSuccess();
+    void recordFailure();
+    // Record a request which tells nothing about the Web Service health: a pending probe is released
+    void recordNeutral();
+
+    eState getState() const;
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_RETRY_POLICY
@@ -0,0 +1,89 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_SCHEDULER
+#define _H_ACCELIZE_DRM_SCHEDULER
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "thread_settings.h"
+#include "timer_wheel.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Scheduler : runs tasks at a given time from a single worker thread, using a
+ timer wheel. Tasks run one at a time, so a task which needs to run again
+ reschedules itself or is periodic rather than sleeping.*/
+class Scheduler {
+
+public:
+    typedef std::chrono::steady_clock TClock;
+    typedef std::function<void()> TTask;
+    typedef uint64_t TTaskId;       ///< 0 is never a valid task ID
+
+protected:
+    TimerWheel mWheel;
+    std::unordered_map<TTaskId, std::pair<TClock::duration, TClock::time_point>> mPeriods;  ///< Period and next run
+    std::vector<TimerWheel::TTimer> mExpired;   ///< Tasks being run by the worker
+    size_t mExpiredNext = 0;                    ///< Next task of mExpired to run
+    TTaskId mNextId = 1;
+    TTaskId mRunningId = 0;
+    std::thread::id mWorkerId;
+    std::future<void> mWorker;
+    mutable std::mutex mMutex;
+    std::condition_variable mWheelCondVar;
+    std::condition_variable mDoneCondVar;
+    bool mStopRequest = false;
+
+    void run();
+
+public:
+    explicit Scheduler( const ThreadSettings& settings = ThreadSettings() );
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+
+    // Scheduler shared by all the DRM managers of the process, created on first use with settings
+    static std::shared_ptr<Scheduler> getShared( const ThreadSettings& settings = ThreadSettings() );
+
+    // Run task at time from the worker thread
+    TTaskId schedule( const TClock::time_point& time, TTask task );
+
+    // Run task at time, then every period until it is canceled
+    TTaskId schedulePeriodic( const TClock::time_point& time, const TClock::duration& period, TTask task );
+
+    // Remove a pending task, or wait for the end of the task if it is running:
+    // return true if the task was pending or is a periodic task
+    bool cancel( const TTaskId& id );
+
+    // Number of pending tasks
+    size_t size() const;
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_SCHEDULER
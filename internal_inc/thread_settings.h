@@ -0,0 +1,56 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_THREAD_SETTINGS
+#define _H_ACCELIZE_DRM_THREAD_SETTINGS
+
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Thread settings : placement, scheduling and stack size of the background
+ threads, applied by the thread itself when it starts. Empty or zero values keep
+ the defaults inherited from the process*/
+struct ThreadSettings {
+    std::string name = "drm_continuity";    ///< Name of the license continuity thread, truncated to 15 characters
+    std::vector<uint32_t> cpu_affinity;     ///< CPUs the threads may run on: all if empty
+    int32_t nice = 0;                       ///< Nice value, only with the "other" and "batch" policies
+    std::string sched_policy;               ///< "other", "batch", "idle", "fifo" or "rr": inherited if empty
+    int32_t sched_priority = 0;             ///< Static priority, only with the "fifo" and "rr" policies
+    size_t stack_size = 0;                  ///< Stack size in bytes: default size if 0
+
+    // Read the "thread_*" keys of the settings: missing keys keep their current value
+    void update( const Json::Value& settings );
+    Json::Value toJson() const;
+
+    // Apply the settings to the calling thread, naming it name
+    void apply( const std::string& thread_name ) const;
+};
+
+// Run function in a new thread named thread_name and configured with settings
+std::future<void> startThread( const ThreadSettings& settings, const std::string& thread_name,
+        std::function<void()> function );
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_THREAD_SETTINGS
@@ -0,0 +1,105 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_TIMER_WHEEL
+#define _H_ACCELIZE_DRM_TIMER_WHEEL
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Hierarchical timer wheel : cLevels levels of cSlots slots, level L slots span
+ cSlots^L ticks. A timer is placed in the lowest level whose current block
+ contains its expiration tick, then moved down level by level as time reaches
+ its slot. Adding and removing a timer is O(1), finding the next tick to process
+ is O(cLevels) thanks to the slot occupancy bitmaps. Timers beyond the top level
+ wait in an overflow list.
+
+ The wheel is not thread-safe.*/
+class TimerWheel {
+
+public:
+    typedef std::chrono::steady_clock TClock;
+    typedef uint64_t TTimerId;
+    typedef std::function<void()> TTask;
+    typedef std::pair<TTimerId, TTask> TTimer;
+
+    static const uint32_t cSlotBits = 6;
+    static const uint32_t cSlots = 1 << cSlotBits;
+    static const uint32_t cLevels = 5;          ///< 2^30 ticks: more than 12 days with 1 ms ticks
+
+protected:
+    struct Entry {
+        TTimerId id;
+        uint64_t tick;
+        TTask task;
+    };
+    typedef std::list<Entry> TSlot;
+
+    struct Location {
+        TSlot* slot;
+        TSlot::iterator it;
+        uint32_t level;     ///< cLevels for the overflow list
+        uint32_t index;
+    };
+
+    TClock::time_point mStart;
+    TClock::duration mResolution;
+    uint64_t mCurrentTick = 0;
+    std::array<std::array<TSlot, cSlots>, cLevels> mSlots;
+    std::array<uint64_t, cLevels> mOccupied;    ///< Bit i is set if slot i of the level is not empty
+    TSlot mOverflow;
+    std::unordered_map<TTimerId, Location> mLocations;
+
+    uint64_t toTick( const TClock::time_point& time ) const;
+    void insert( Entry&& entry );
+    void unlink( const Location& location );
+    void cascade( const uint32_t& level, const uint32_t& index );
+    uint64_t getNextEventTick() const;
+
+public:
+    explicit TimerWheel( const TClock::duration& resolution = std::chrono::milliseconds( 1 ),
+            const TClock::time_point& start = TClock::now() );
+
+    TimerWheel(const TimerWheel&) = delete;
+
+    // Add a timer expiring at time: id must be unique
+    void add( const TTimerId& id, const TClock::time_point& time, TTask task );
+
+    // Remove a pending timer: return false if it is not pending
+    bool remove( const TTimerId& id );
+
+    // Move the timers expired at time to the end of expired, in expiration order
+    void advance( const TClock::time_point& time, std::vector<TTimer>& expired );
+
+    // Time at which advance has something to do: TClock::time_point::max() if no timer is pending
+    TClock::time_point getNextWakeup() const;
+
+    size_t size() const { return mLocations.size(); }
+    bool empty() const { return mLocations.empty(); }
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_TIMER_WHEEL
@@ -0,0 +1,57 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_TRACE
+#define _H_ACCELIZE_DRM_TRACE
+
+/*
+Static tracepoints (USDT) of the "accelize_drm" provider.
+
+When built with SystemTap SDT headers (HAVE_SYS_SDT_H), each tracepoint is a
+single NOP instruction plus an ELF note that tools like bpftrace, perf or
+SystemTap use to attach a probe at runtime: the cost is negligible when no probe
+is attached. Otherwise tracepoints are compiled out and their arguments are
+never evaluated.
+
+Tracepoint arguments must be integers or pointers.
+*/
+
+#ifdef HAVE_SYS_SDT_H
+
+#include <sys/sdt.h>
+
+// Tracepoint without argument
+#define DRM_TRACE( name ) STAP_PROBE( accelize_drm, name )
+
+// Tracepoint with up to 12 arguments
+#define DRM_TRACE_ARGS( name, ... ) STAP_PROBEV( accelize_drm, name, __VA_ARGS__ )
+
+// Fire "<name>_entry" now and "<name>_return" when leaving the current scope, even on exception
+#define DRM_TRACE_SCOPE( name ) \
+    DRM_TRACE( name##_entry ); \
+    struct DrmTraceScope_##name { \
+        ~DrmTraceScope_##name() { DRM_TRACE( name##_return ); } \
+    } drmTraceScope_##name
+
+#else
+
+#define DRM_TRACE( name ) ((void)0)
+#define DRM_TRACE_ARGS( name, ... ) ((void)0)
+#define DRM_TRACE_SCOPE( name ) ((void)0)
+
+#endif // HAVE_SYS_SDT_H
+
+#endif // _H_ACCELIZE_DRM_TRACE
@@ -17,7 +17,9 @@ limitations under the License.
 #ifndef _H_ACCELIZE_METERING_UTILS
 #define _H_ACCELIZE_METERING_UTILS
 
+#include <chrono>
 #include <iostream>
+#include <vector>
 #include <json/json.h>
 
 namespace Accelize {
@@ -28,10 +30,14 @@ bool isDir( const std::string& dir_path );
 bool isFile( const std::string& file_path );
 bool makeDirs( const std::string& dir_path, mode_t mode = 744 );
 
+// Format a time as ISO 8601 UTC with milliseconds, like "2020-03-02T10:15:31.402Z"
+std::string getISO8601Time( const std::chrono::system_clock::time_point& time );
+
 std::string saveJsonToString( const Json::Value& json_value, const std::string& indent = "" );
 void saveJsonToFile( const std::string& file_path, const Json::Value& json_value, const std::string& indent = "\t" );
 Json::Value parseJsonString(const std::string &json_string);
 Json::Value parseJsonFile(const std::string &file_path);
+bool extractJsonValues( const std::string& json_string, const std::vector<std::vector<std::string>>& paths, Json::Value& values );
 const Json::Value& JVgetRequired( const Json::Value& json_value, const char* key, const Json::ValueType& type );
 const Json::Value& JVgetOptional( const Json::Value& json_value, const char* key, const Json::ValueType& type, const Json::Value& defaultValue = Json::nullValue );
 
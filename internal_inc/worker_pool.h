@@ -0,0 +1,66 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _H_ACCELIZE_DRM_WORKER_POOL
+#define _H_ACCELIZE_DRM_WORKER_POOL
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+#include "thread_settings.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+/*Worker pool : runs tasks in submission order from a fixed number of worker
+ threads, for blocking work such as Web Service requests. Unlike the scheduler,
+ a task may block: it only delays the tasks queued behind it when all the
+ workers are busy*/
+class WorkerPool {
+
+public:
+    typedef std::function<void()> TTask;
+
+protected:
+    std::vector<std::future<void>> mWorkers;
+    std::deque<TTask> mQueue;
+    std::mutex mMutex;
+    std::condition_variable mCondVar;
+    bool mStopRequest = false;
+
+    void run();
+
+public:
+    WorkerPool( const size_t& num_workers, const ThreadSettings& settings = ThreadSettings() );
+    ~WorkerPool();  // Run the queued tasks before returning
+
+    WorkerPool( const WorkerPool& ) = delete;
+
+    // Queue task: never blocks on the running tasks
+    void submit( TTask task );
+
+    size_t size() const { return mWorkers.size(); }
+};
+
+}
+}
+
+#endif // _H_ACCELIZE_DRM_WORKER_POOL
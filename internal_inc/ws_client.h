@@ -20,9 +20,17 @@ limitations under the License.
 #include <string>
 #include <list>
 #include <chrono>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <vector>
 #include <json/json.h>
 #include <curl/curl.h>
 
+#include "drm_config.h"
+#include "metrics.h"
+#include "event_log.h"
+
 //#include "log.h"
 
 namespace Accelize {
@@ -42,13 +50,27 @@ public:
 };
 
 
+// Breakdown of the time spent in a HTTP request, in seconds
+struct CurlTimings {
+    double dns = 0;         ///< Name resolution
+    double connect = 0;     ///< TCP connection
+    double tls = 0;         ///< SSL/TLS handshake
+    double ttfb = 0;        ///< From request sent to first response byte (server processing)
+    double transfer = 0;    ///< Response transfer
+    double total = 0;
+};
+
+
 // RAII for Curl easy
 class CurlEasyPost {
 private:
     CURL *curl;
     struct curl_slist *headers = nullptr;
     std::list<std::string> data; // keep data until request performed
+    std::list<std::string> header_data;
     std::array<char, CURL_ERROR_SIZE> errbuff;
+    long mRetryAfter = 0;   // Delay in seconds requested by the server with the Retry-After header
+    std::string* mResponse = nullptr;
 
 public:
 
@@ -78,6 +100,8 @@ public:
 
     long perform(std::string* resp, std::chrono::steady_clock::time_point deadline);
     double getTotalTime();
+    CurlTimings getTimings();
+    long getRetryAfter() const { return mRetryAfter; }
 
     template<class T>
     void setURL(T&& url) {
@@ -87,8 +111,15 @@ public:
 
     template<class T>
     void appendHeader(T&& header) {
-        data.push_back(std::forward<T>(header));
-        headers = curl_slist_append(headers, data.back().c_str());
+        header_data.push_back(std::forward<T>(header));
+        headers = curl_slist_append(headers, header_data.back().c_str());
+    }
+
+    // Remove the headers, to set new ones on a reused handle
+    void clearHeaders() {
+        curl_slist_free_all(headers);
+        headers = nullptr;
+        header_data.clear();
     }
 
     template<class T>
@@ -97,6 +128,12 @@ public:
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.back().c_str());
     }
 
+    // Post data is not copied: the buffer must be kept until request performed
+    void setPostBuffer(const std::string& buffer) {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, (long)buffer.size());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, buffer.c_str());
+    }
+
 protected:
 
     static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
@@ -105,6 +142,67 @@ protected:
         s->append((const char*)contents, realsize);
         return realsize;
     }
+
+    static size_t header_callback(char *buffer, size_t size, size_t nitems, void *userp);
+};
+
+
+/*Web Service request statistics : latency histograms of each request phase
+ and counts of response codes and retried errors*/
+class WSRequestStatistics {
+
+protected:
+    mutable std::mutex mMutex;
+    std::map<std::string, uint64_t> mResponseCodes;
+    std::map<std::string, uint64_t> mRetryableErrors;
+    Histogram mDnsTime;
+    Histogram mConnectTime;
+    Histogram mTlsTime;
+    Histogram mTtfbTime;
+    Histogram mTransferTime;
+    Histogram mTotalTime;
+
+public:
+    WSRequestStatistics();
+
+    void recordResponse( const long& resp_code, const CurlTimings& timings );
+    void recordRetryableError( const std::string& reason );
+
+    std::map<std::string, uint64_t> getResponseCodes() const;
+    std::map<std::string, uint64_t> getRetryableErrors() const;
+    // Return the latency histograms by phase name
+    std::vector<std::pair<std::string, const Histogram*>> getPhaseTimes() const;
+
+    Json::Value toJson() const;
+};
+
+
+/*Token cache : shares OAuth2 tokens between processes of the same user through
+ a permission-restricted file keyed by client ID and licensing URL*/
+class TokenCache {
+
+protected:
+
+    std::string mFilePath;
+    std::string mLockFilePath;
+    int mLockFd = -1;
+
+public:
+    TokenCache( const std::string& dir_path, const std::string& client_id, const std::string& url );
+    ~TokenCache();
+
+    TokenCache(const TokenCache&) = delete;
+
+    const std::string& getFilePath() const { return mFilePath; }
+
+    // Serialize token refresh between processes; return false if the lock could not be taken before deadline
+    bool lock( std::chrono::steady_clock::time_point deadline );
+    void unlock();
+
+    bool load( std::string& token, uint32_t& validity, std::chrono::system_clock::time_point& expiration ) const;
+    void save( const std::string& token, const uint32_t& validity, const std::chrono::system_clock::time_point& expiration ) const;
+    // Remove the cached file if it still holds token, under the lock if it can be taken before deadline
+    void remove( const std::string& token, std::chrono::steady_clock::time_point deadline );
 };
 
 
@@ -124,19 +222,65 @@ protected:
     uint32_t mTokenValidityPeriod;
     TClock::time_point mTokenExpirationTime;
     CurlEasyPost mOAUth2Request;
+    std::unique_ptr<TokenCache> mTokenCache;
+    bool mTokenFromCache = false;
+    std::shared_ptr<WSRequestStatistics> mOAuth2Statistics;
+    std::shared_ptr<WSRequestStatistics> mLicenseStatistics;
+    std::shared_ptr<EventLog> mEventLog;
+    std::unique_ptr<Json::StreamWriter> mJsonWriter;
+    std::string mRequestBuffer;     // Reused between license requests to keep its capacity
+    // Idle license request handles with the token of their authorization header: a handle is reused
+    // with its connection to the Web Service, each concurrent request takes its own handle
+    std::vector<std::pair<std::unique_ptr<CurlEasyPost>, std::string>> mLicenseHandles;
+    // Response fields used to install the license, by DNA
+    std::map<std::string, std::vector<std::vector<std::string>>> mLicensePaths;
+    std::mutex mLicenseCacheMutex;  // Protect mLicenseHandles and mLicensePaths
+    // Protect the token and the OAuth2 request: license requests of the DRM managers sharing
+    // this client run concurrently
+    mutable std::recursive_mutex mMutex;
+
+    long performRequest( CurlEasyPost& req, std::string& response, TClock::time_point deadline,
+            WSRequestStatistics& statistics, const std::string& ws_name );
+    void requestOAuth2tokenFromWS( TClock::time_point deadline );
+    bool loadOAuth2tokenFromCache();
+    std::unique_ptr<CurlEasyPost> acquireLicenseHandle( const std::string& token );
+    void releaseLicenseHandle( std::unique_ptr<CurlEasyPost> req, const std::string& token );
+    const std::vector<std::vector<std::string>>& getLicensePaths( const std::string& dna );
 
 public:
-    DrmWSClient(const std::string &conf_file_path, const std::string &cred_file_path);
+    explicit DrmWSClient( const DrmConfig& config );
     ~DrmWSClient() = default;
 
     uint32_t getTokenValidity() const { return mTokenValidityPeriod; }
     uint32_t getTokenTimeLeft() const;
-    std::string getTokenString() const { return mOAuth2Token; }
+    std::string getTokenString() const {
+        std::lock_guard<std::recursive_mutex> lock( mMutex );
+        return mOAuth2Token;
+    }
+    // Retry-After delay in seconds of the last request of the calling thread, 0 if none
+    long getRetryAfter() const;
+    // HTTP code of the last request of the calling thread, 0 if it got no response
+    long getResponseCode() const;
+    Json::Value getOAuth2Statistics() const { return mOAuth2Statistics->toJson(); }
+    Json::Value getLicenseStatistics() const { return mLicenseStatistics->toJson(); }
+    // Share statistics between clients
+    void setStatistics( const std::shared_ptr<WSRequestStatistics>& oauth2_statistics,
+            const std::shared_ptr<WSRequestStatistics>& license_statistics ) {
+        mOAuth2Statistics = oauth2_statistics;
+        mLicenseStatistics = license_statistics;
+    }
+    // Write each request attempt to this event log, disabled if null
+    void setEventLog( const std::shared_ptr<EventLog>& event_log ) { mEventLog = event_log; }
+    bool hasEventLog() const { return mEventLog != nullptr; }
 
     void setOAuth2token( const std::string& token );
 
     void requestOAuth2token(TClock::time_point deadline);
-    Json::Value requestLicense( const Json::Value& json_req, TClock::time_point deadline );
+    Json::Value requestLicense( const Json::Value& json_req, TClock::time_point deadline, bool full_response = false );
+
+    // Send a serialized request: dna selects the license to extract from the response
+    Json::Value requestLicense( const std::string& request_body, const std::string& dna, TClock::time_point deadline,
+            bool full_response = false );
 
 };
 
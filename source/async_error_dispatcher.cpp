@@ -0,0 +1,127 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "log.h"
+#include "async_error_dispatcher.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+bool AsyncErrorDispatcher::State::deliverOne() {
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> lock( mutex );
+        if ( queue.empty() )
+            return false;
+        entry = std::move( queue.front() );
+        queue.pop_front();
+    }
+    if ( entry.repeats )
+        entry.message += fmt::format( " (occurred {} times)", entry.repeats + 1 );
+    try {
+        callback( entry.message );
+    } catch( const std::exception& e ) {
+        Error( "Asynchronous error callback failed: {}", e.what() );
+    }
+    return true;
+}
+
+
+AsyncErrorDispatcher::AsyncErrorDispatcher( TCallback callback, const size_t& max_size,
+        const ThreadSettings& settings, Counter& coalesced, Counter& dropped, TExecutor default_executor )
+        : mState( std::make_shared<State>() ), mMaxSize( max_size ), mCoalesced( coalesced ), mDropped( dropped ),
+          mExecutor( default_executor ), mDefaultExecutor( default_executor ) {
+    mState->callback = std::move( callback );
+    if ( !mDefaultExecutor )
+        mThread = startThread( settings, "drm_async_err", [ this ]() { run(); } );
+}
+
+AsyncErrorDispatcher::~AsyncErrorDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock( mState->mutex );
+        mStopRequest = true;
+    }
+    mCondVar.notify_all();
+    if ( mThread.valid() )
+        mThread.get();
+}
+
+void AsyncErrorDispatcher::run() {
+    while ( 1 ) {
+        {
+            std::unique_lock<std::mutex> lock( mState->mutex );
+            mCondVar.wait( lock, [ this ]{ return mStopRequest || ( !mExecutor && !mState->queue.empty() ); } );
+            if ( mStopRequest )
+                break;
+        }
+        mState->deliverOne();
+    }
+    // Errors still queued are not lost
+    while ( mState->deliverOne() );
+}
+
+void AsyncErrorDispatcher::setExecutor( TExecutor executor ) {
+    if ( !executor )
+        executor = mDefaultExecutor;
+    size_t num_queued;
+    {
+        std::lock_guard<std::mutex> lock( mState->mutex );
+        mExecutor = executor;
+        num_queued = mState->queue.size();
+    }
+    if ( !executor ) {
+        mCondVar.notify_all();
+        return;
+    }
+    std::shared_ptr<State> state = mState;
+    for( size_t i = 0; i < num_queued; i++ )
+        executor( [ state ]() { state->deliverOne(); } );
+}
+
+void AsyncErrorDispatcher::push( const std::string& message ) {
+    TExecutor executor;
+    {
+        std::lock_guard<std::mutex> lock( mState->mutex );
+        for( Entry& entry: mState->queue ) {
+            if ( entry.message == message ) {
+                entry.repeats++;
+                mCoalesced.inc();
+                return;
+            }
+        }
+        if ( mState->queue.size() >= mMaxSize ) {
+            mDropped.inc();
+            Warning( "Asynchronous error queue is full, dropping error: {}", message );
+            return;
+        }
+        mState->queue.push_back( Entry{ message, 0 } );
+        executor = mExecutor;
+    }
+    if ( !executor ) {
+        mCondVar.notify_one();
+        return;
+    }
+    std::shared_ptr<State> state = mState;
+    try {
+        executor( [ state ]() { state->deliverOne(); } );
+    } catch( const std::exception& e ) {
+        Error( "Asynchronous error executor failed: {}", e.what() );
+    }
+}
+
+}
+}
@@ -34,29 +34,34 @@ void checkPointer(void *p) {
         Throw( DRM_BadArg, "Provided pointer is NULL" );
 }
 
-/* Help macros TRY/CATCH to return code error */
+// Copy the message of an exception, truncated to MAX_MSG_SIZE
+static void setErrorMessage( DrmManager *m, const char* message ) {
+    if ( m == NULL )
+        return;
+    size_t cp_size = strlen( message );
+    if ( cp_size >= MAX_MSG_SIZE ) {
+        cp_size = MAX_MSG_SIZE - 6;
+        strcpy( m->error_message + cp_size, "[...]" );
+    } else {
+        m->error_message[cp_size] = '\0';
+    }
+    memcpy( m->error_message, message, cp_size );
+}
+
+/* Help macros TRY/CATCH to return code error: the error message is an empty
+   string on success, so clearing its first character is enough */
 #define TRY                                        \
     DRM_ErrorCode __try_ret = DRM_OK;              \
     if ( m != NULL )                               \
-        memset(m->error_message, 0, MAX_MSG_SIZE); \
+        m->error_message[0] = '\0';                \
     try {
 
 #define CATCH_RETURN                                          \
     } catch( const cpp::Exception& e ) {                      \
-        int cp_size = strlen( e.what() );                     \
-        if ( cp_size >= MAX_MSG_SIZE ) {                      \
-            cp_size = MAX_MSG_SIZE - 6;                       \
-            strcpy( m->error_message + cp_size, "[...]" );    \
-        }                                                     \
-        strncpy( m->error_message, e.what(), cp_size );       \
+        setErrorMessage( m, e.what() );                       \
         __try_ret = e.getErrCode();                           \
     } catch( const std::exception& e ) {                      \
-        int cp_size = strlen( e.what() );                     \
-        if ( cp_size >= MAX_MSG_SIZE ) {                      \
-            cp_size = MAX_MSG_SIZE - 6;                       \
-            strcpy( m->error_message + cp_size, "[...]" );    \
-        }                                                     \
-        strncpy( m->error_message, e.what(), cp_size );       \
+        setErrorMessage( m, e.what() );                       \
         SPDLOG_ERROR( e.what() );                             \
         __try_ret = DRM_Fatal;                                \
     }                                                         \
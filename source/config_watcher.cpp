@@ -0,0 +1,94 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+#include "log.h"
+#include "config_watcher.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+ConfigWatcher::ConfigWatcher( const std::string& file_path ): mFilePath( file_path ) {
+#ifdef __linux__
+    // Watch the directory: editors and deployment tools often replace the file instead of writing it
+    std::string dir_path( "." );
+    mFileName = file_path;
+    size_t pos = file_path.find_last_of( '/' );
+    if ( pos != std::string::npos ) {
+        dir_path = ( pos == 0 ) ? "/" : file_path.substr( 0, pos );
+        mFileName = file_path.substr( pos + 1 );
+    }
+    mFd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if ( mFd < 0 )
+        Throw( DRM_ExternFail, "Failed to watch configuration file {}: {}", file_path, strerror( errno ) );
+    if ( inotify_add_watch( mFd, dir_path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO ) < 0 ) {
+        int err = errno;
+        close( mFd );
+        mFd = -1;
+        Throw( DRM_ExternFail, "Failed to watch configuration file {}: {}", file_path, strerror( err ) );
+    }
+#else
+    mModificationTime = getModificationTime();
+#endif
+    Debug( "Watching configuration file {}", file_path );
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    if ( mFd >= 0 )
+        close( mFd );
+}
+
+time_t ConfigWatcher::getModificationTime() const {
+    struct stat file_stat;
+    if ( stat( mFilePath.c_str(), &file_stat ) != 0 )
+        return 0;
+    return file_stat.st_mtime;
+}
+
+bool ConfigWatcher::hasChanged() {
+#ifdef __linux__
+    bool changed = false;
+    alignas( struct inotify_event ) char buffer[4096];
+    ssize_t length;
+    while ( ( length = read( mFd, buffer, sizeof( buffer ) ) ) > 0 ) {
+        for( char* ptr = buffer; ptr < buffer + length; ) {
+            const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>( ptr );
+            // Events lost on overflow may include the file
+            if ( ( event->mask & IN_Q_OVERFLOW ) || ( event->len && ( mFileName == event->name ) ) )
+                changed = true;
+            ptr += sizeof( struct inotify_event ) + event->len;
+        }
+    }
+    return changed;
+#else
+    time_t modification_time = getModificationTime();
+    if ( modification_time == mModificationTime )
+        return false;
+    mModificationTime = modification_time;
+    return true;
+#endif
+}
+
+}
+}
@@ -0,0 +1,102 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "log.h"
+#include "utils.h"
+#include "drm_config.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+std::shared_ptr<const DrmConfig> DrmConfig::load( const std::string& conf_file_path,
+        const std::string& cred_file_path ) {
+    std::shared_ptr<DrmConfig> config = std::make_shared<DrmConfig>();
+    config->conf_file_path = conf_file_path;
+    config->cred_file_path = cred_file_path;
+
+    Json::Value conf_json = parseJsonFile( conf_file_path );
+
+    try {
+        config->settings = JVgetOptional( conf_json, "settings", Json::objectValue );
+
+        // Design configuration
+        Json::Value conf_design = JVgetOptional( conf_json, "design", Json::objectValue );
+        if ( !conf_design.empty() ) {
+            config->udid = JVgetOptional( conf_design, "udid", Json::stringValue, "" ).asString();
+            config->board_type = JVgetOptional( conf_design, "boardType", Json::stringValue, "" ).asString();
+        }
+
+        // Licensing configuration
+        config->mLicensing = JVgetRequired( conf_json, "licensing", Json::objectValue );
+        // Get licensing mode
+        config->nodelocked = JVgetOptional( config->mLicensing, "nodelocked", Json::booleanValue, false ).asBool();
+        if ( config->nodelocked ) {
+            // If this is a node-locked license, get the license path
+            config->license_dir = JVgetRequired( config->mLicensing, "license_dir", Json::stringValue ).asString();
+            Debug( "Configuration file specifies a Node-locked license" );
+        } else {
+            Debug( "Configuration file specifies a floating/metered license" );
+            // Get DRM frequency
+            Json::Value conf_drm = JVgetRequired( conf_json, "drm", Json::objectValue );
+            config->frequency_mhz = JVgetRequired( conf_drm, "frequency_mhz", Json::intValue ).asUInt();
+        }
+
+    } catch( Exception &e ) {
+        if ( e.getErrCode() != DRM_BadFormat )
+            throw;
+        Throw( DRM_BadFormat, "Error in configuration file '{}: {}", conf_file_path, e.what() );
+    }
+    return config;
+}
+
+bool DrmConfig::hasSameLicensing( const DrmConfig& other ) const {
+    return ( udid == other.udid ) && ( board_type == other.board_type ) && ( nodelocked == other.nodelocked )
+            && ( license_dir == other.license_dir ) && ( frequency_mhz == other.frequency_mhz )
+            && ( mLicensing == other.mLicensing );
+}
+
+const WebServiceConfig& DrmConfig::getWebService() const {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mWebService )
+        return *mWebService;
+
+    std::unique_ptr<WebServiceConfig> web_service( new WebServiceConfig );
+    try {
+        Debug2( "Web service configuration: {}", mLicensing.toStyledString() );
+        web_service->url = JVgetRequired( mLicensing, "url", Json::stringValue ).asString();
+        Debug( "Licensing URL: {}", web_service->url );
+        if ( settings != Json::nullValue )
+            web_service->token_cache_dir = JVgetOptional( settings, "token_cache_dir", Json::stringValue, "" ).asString();
+    } catch( Exception &e ) {
+        Throw( e.getErrCode(), "Error with service configuration file '{}': {}",
+                conf_file_path, e.what() );
+    }
+
+    try {
+        Json::Value cred_json = parseJsonFile( cred_file_path );
+        web_service->client_id = JVgetRequired( cred_json, "client_id", Json::stringValue ).asString();
+        web_service->client_secret = JVgetRequired( cred_json, "client_secret", Json::stringValue ).asString();
+    } catch( Exception &e ) {
+        Throw( e.getErrCode(), "Error with credential file '{}': {}", cred_file_path, e.what() );
+    }
+
+    mWebService = std::move( web_service );
+    return *mWebService;
+}
+
+}
+}
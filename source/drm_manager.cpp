@@ -28,6 +28,8 @@ limitations under the License.
 #include <mutex>
 #include <condition_variable>
 #include <queue>
+#include <set>
+#include <unordered_map>
 #include <fstream>
 #include <typeinfo>
 #include <sys/types.h>
@@ -36,8 +38,22 @@ limitations under the License.
 #include <algorithm>
 
 #include "accelize/drm/drm_manager.h"
+#include "accelize/drm/drm_manager_group.h"
 #include "accelize/drm/version.h"
+#include "config_watcher.h"
+#include "drm_config.h"
 #include "ws_client.h"
+#include "retry_policy.h"
+#include "metering_journal.h"
+#include "metering_request.h"
+#include "metrics.h"
+#include "event_log.h"
+#include "hw_snapshot.h"
+#include "scheduler.h"
+#include "worker_pool.h"
+#include "async_error_dispatcher.h"
+#include "thread_settings.h"
+#include "trace.h"
 #include "log.h"
 #include "utils.h"
 
@@ -70,12 +86,49 @@ const char* getApiVersion() {
 }
 
 
+// Names of the parameters, indexed by ParameterKey
+static const std::string* getParameterKeyNames() {
+    static const std::string names[] = {
+    #   define PARAMETERKEY_ITEM(id) #id,
+    #   include "accelize/drm/ParameterKey.def"
+    #   undef PARAMETERKEY_ITEM
+        "ParameterKeyCount"
+    };
+    return names;
+}
+
+// Parameters by name, built once
+static const std::unordered_map<std::string, ParameterKey>& getParameterKeyIds() {
+    static const std::unordered_map<std::string, ParameterKey> ids = []() {
+        std::unordered_map<std::string, ParameterKey> map;
+        map.reserve( ParameterKeyCount + 1 );
+        for( int i=0; i<=ParameterKeyCount; i++ )
+            map.emplace( getParameterKeyNames()[i], static_cast<ParameterKey>( i ) );
+        return map;
+    }();
+    return ids;
+}
+
+
+// Resources shared by the slots of a DrmManagerGroup
+struct DRM_LOCAL GroupResources {
+    std::shared_ptr<const DrmConfig> config;    ///< Configuration file parsed once
+    std::shared_ptr<DrmWSClient> ws_client; ///< Shares the credentials, the OAuth2 token and the connections
+    std::shared_ptr<WSRequestStatistics> oauth2_statistics = std::make_shared<WSRequestStatistics>();
+    std::shared_ptr<WSRequestStatistics> license_statistics = std::make_shared<WSRequestStatistics>();
+    std::unique_ptr<Scheduler> scheduler;   ///< Single worker waking up the slots at their license renewal deadline
+    std::unique_ptr<WorkerPool> workers;    ///< Few workers running the license continuity steps of all slots
+};
+
+
 class DRM_LOCAL DrmManager::Impl {
 
 protected:
 
     // Helper typedef
     typedef std::chrono::steady_clock TClock; /// Shortcut type def to steady clock which is monotonic (so unaffected by clock adjustments)
+    typedef TimedMutex<std::recursive_mutex> TControllerMutex;
+    typedef TimedLockGuard<std::recursive_mutex> TControllerLock;
 
     // Enum
     enum class eLogFileType: uint8_t {NONE=0, BASIC, ROTATING};
@@ -89,6 +142,12 @@ protected:
     const uint32_t HDK_COMPATIBLITY_LIMIT_MAJOR = 3;
     const uint32_t HDK_COMPATIBLITY_LIMIT_MINOR = 1;
 
+    // Minimum delay before checking again the DRM Controller readiness for a new license
+    const TClock::duration LICENSE_CHECK_MIN_DELAY = std::chrono::milliseconds( 100 );
+
+    // Delay after which a thread waiting for a scheduler wakeup stops waiting on its own
+    const TClock::duration SCHEDULER_WAKEUP_SLACK = std::chrono::milliseconds( 50 );
+
     const std::map<eLicenseType, std::string> LicenseTypeStringMap = {
             {eLicenseType::NONE       , "Idle"},
             {eLicenseType::METERED    , "Floating/Metering"},
@@ -104,9 +163,10 @@ protected:
     bool mSecurityStop;
 
     // Composition
-    std::unique_ptr<DrmWSClient> mWsClient;
+    std::shared_ptr<DrmWSClient> mWsClient;
     std::unique_ptr<DrmControllerLibrary::DrmControllerOperations> mDrmController;
-    mutable std::recursive_mutex mDrmControllerMutex;
+    mutable std::vector<uint32_t> mHwReportLayout;    ///< Register lines read in each page by the HW report
+    mutable TControllerMutex mDrmControllerMutex;
     bool mIsLockedToDrm = false;
 
     // Logging parameters
@@ -127,14 +187,20 @@ protected:
     size_t       sLogServiceRotatingSize = 100*1024*1024;
     size_t       sLogServiceRotatingNum  = 3;
 
+    bool         sLogAsync               = false;   ///< Write log messages from a background thread
+    size_t       sLogAsyncQueueSize      = 8192;    ///< Maximum number of messages waiting to be written
+    std::string  sLogAsyncOverflowPolicy = std::string("block");  ///< "block" or "overrun_oldest" when the queue is full
+    bool         mLogAsyncUser           = false;   ///< This instance holds a reference on the shared log thread pool
+
     // Function callbacks
     DrmManager::ReadRegisterCallback  f_read_register;
     DrmManager::WriteRegisterCallback f_write_register;
     DrmManager::AsynchErrorCallback   f_asynch_error;
+    uint32_t mAsyncErrorQueueSize = 0;      ///< Maximum number of queued asynchronous errors: 0 to call f_asynch_error directly
+    std::unique_ptr<AsyncErrorDispatcher> mAsyncErrorDispatcher;
 
-    // Settings files
-    std::string mConfFilePath;
-    std::string mCredFilePath;
+    // Configuration, shared with the other slots of a group
+    std::shared_ptr<const DrmConfig> mConfig;
 
     // Node-Locked parameters
     std::string mNodeLockLicenseDirPath;
@@ -142,9 +208,31 @@ protected:
     std::string mNodeLockLicenseFilePath;
 
     // License related properties
-    uint32_t mWSRetryPeriodLong  = 60;    ///< Time in seconds before the next request attempt to the Web Server when the time left before timeout is large
-    uint32_t mWSRetryPeriodShort = 2;     ///< Time in seconds before the next request attempt to the Web Server when the time left before timeout is short
-    uint32_t mWSRequestTimeout   = 10;    ///< Time in seconds during which retries occur
+    // Settings which can change at runtime: they are replaced as a whole under the mutex,
+    // each operation works on its own copy
+    struct RuntimeSettings {
+        uint32_t ws_retry_period_long  = 60;   ///< Time in seconds before the next request attempt to the Web Server when the time left before timeout is large
+        uint32_t ws_retry_period_short = 2;    ///< Time in seconds before the next request attempt to the Web Server when the time left before timeout is short
+        uint32_t ws_request_timeout    = 10;   ///< Time in seconds during which retries occur
+        uint32_t frequency_detection_period = 100;      // in milliseconds
+        double frequency_detection_threshold = 2.0;     // Error in percentage
+
+        void validate() const {
+            if ( ws_request_timeout == 0 )
+                Throw( DRM_BadArg, "ws_request_timeout must not be 0" );
+            if ( ws_retry_period_long <= ws_retry_period_short )
+                Throw( DRM_BadArg, "ws_retry_period_long ({}) must be greater than ws_retry_period_short ({})",
+                        ws_retry_period_long, ws_retry_period_short );
+        }
+    };
+    RuntimeSettings mRuntimeSettings;
+    mutable std::mutex mRuntimeSettingsMtx;
+    std::string mWSRetryPolicyName = "fixed";    ///< Name of the retry policy: fixed or exponential
+    uint32_t mWSRetryMaxAttempts = 0;     ///< Maximum number of retries per request deadline: 0 for no limit
+    uint32_t mWSCircuitBreakerThreshold = 0;   ///< Consecutive failed requests opening the circuit breaker: 0 to disable
+    uint32_t mWSCircuitBreakerCooldown = 30;   ///< Time in seconds during which the circuit breaker stays open
+    std::unique_ptr<RetryPolicy> mRetryPolicy;
+    CircuitBreaker mCircuitBreaker;
 
     eLicenseType mLicenseType = eLicenseType::METERED;
     uint32_t mLicenseCounter;
@@ -153,8 +241,6 @@ protected:
     // Design parameters
     int32_t mFrequencyInit;
     int32_t mFrequencyCurr;
-    uint32_t mFrequencyDetectionPeriod = 100;  // in milliseconds
-    double mFrequencyDetectionThreshold = 2.0;      // Error in percentage
 
     // Session state
     std::string mSessionID;
@@ -163,52 +249,122 @@ protected:
 
     // Web service communication
     Json::Value mHeaderJsonRequest;
+    MeteringRequestTemplate mRequestTemplate;   ///< mHeaderJsonRequest serialized once
 
     // thread to maintain alive
     std::future<void> mThreadKeepAlive;
+    ThreadSettings mThreadSettings;             ///< Placement and priority of the background threads
+    std::shared_ptr<GroupResources> mGroup;     ///< Set if this is a slot of a DrmManagerGroup
+    TClock::time_point mLicenseExpirationWakeup;    ///< Expected expiration of the current license, if waiting for it
+    std::shared_ptr<Scheduler> mScheduler;      ///< Process-wide scheduler running the periodic housekeeping tasks
     std::mutex mThreadKeepAliveMtx;
     std::condition_variable mThreadKeepAliveCondVar;
     bool mThreadStopRequest{false};
+    bool mContinuityPooled = false;             ///< Slot of a group: the continuity runs as jobs of the group workers
+    bool mContinuityActive = false;             ///< A continuity job of the slot is queued, running or scheduled
+    Scheduler::TTaskId mContinuityTask = 0;     ///< Group scheduler task queuing the next continuity job
+
+    // Thread uploading the metering journal
+    std::string mMeteringJournalDir;    ///< Enable asynchronous deactivate when not empty
+    std::unique_ptr<MeteringJournal> mMeteringJournal;
+    std::future<void> mThreadJournal;
+    std::mutex mThreadJournalMtx;
+    std::condition_variable mThreadJournalCondVar;
+    bool mThreadJournalRunning{false};
+    bool mThreadJournalUploadRequest{false};
+    bool mThreadJournalStopRequest{false};
+    bool mThreadJournalFinalAttempt{false};     ///< Upload the journal once without retrying, then stop
+
+    // Metrics
+    struct Metrics {
+        Counter registerReads;
+        Counter registerWrites;
+        Counter registerErrors;
+        Counter pageSwitches;
+        Counter pollIterations;
+        Counter earlyWakeups;
+        Counter asyncErrorsCoalesced;
+        Counter asyncErrorsDropped;
+        Counter housekeepingSkipped;
+        Counter licensesInstalled;
+        Histogram renewalLatency{ Histogram::exponentialBounds( 5 ) };      // in ms
+        Histogram timeLeftAtRenewal{ Histogram::exponentialBounds( 4 ) };   // in seconds
+        Histogram wakeupDelay{ Histogram::exponentialBounds( 6 ) };         // in us
+        Histogram lockWait{ Histogram::exponentialBounds( 6 ) };            // in us
+        Histogram lockHold{ Histogram::exponentialBounds( 7 ) };            // in us
+    };
+    mutable Metrics mMetrics;
+    MetricsRegistry mMetricsRegistry;
+    std::shared_ptr<WSRequestStatistics> mOAuth2Statistics = std::make_shared<WSRequestStatistics>();
+    std::shared_ptr<WSRequestStatistics> mLicenseStatistics = std::make_shared<WSRequestStatistics>();
+
+    // Thread writing the metrics file
+    std::string mMetricsFilePath;           ///< Prometheus text file, disabled if empty
+    uint32_t mMetricsFilePeriod = 60;       ///< Time in seconds between 2 writes of the metrics file
+    Scheduler::TTaskId mMetricsTask = 0;
+
+    // Event log
+    std::string mEventLogPath;              ///< JSON lines file, disabled if empty
+    size_t mEventLogRotatingSize = 10*1024*1024;
+    size_t mEventLogRotatingNum = 3;
+    std::shared_ptr<EventLog> mEventLog;
+
+    // Activators status
+    uint32_t mActivatorBaseAddr = 0x10000;      ///< Offset of the 1st activator status register from the DRM Controller base
+    uint32_t mActivatorStride = 0x10000;        ///< Address gap between 2 consecutive activators
+    uint32_t mActivatorsStatusPeriod = 0;       ///< Time in ms between 2 refreshes of the cached status: 0 to read on request
+    mutable std::mutex mActivatorsStatusMtx;
+    uint32_t mNumActivators = 0;                ///< Number of activators, read from the DRM Controller at construction
+    mutable std::vector<uint32_t> mActivatorsStatus;
+    mutable TClock::time_point mActivatorsStatusTime;
+    Scheduler::TTaskId mActivatorsStatusTask = 0;
+
+    // Metered data sampling
+    typedef std::pair<std::chrono::system_clock::time_point, uint64_t> TMeteredDataSample;
+    uint32_t mMeteredDataSamplingPeriod = 0;    ///< Time in ms between 2 samples of the metered data: 0 to disable
+    uint32_t mMeteredDataSamplingSize = 1024;   ///< Maximum number of samples kept until they are read
+    mutable std::mutex mMeteredDataSamplesMtx;
+    mutable std::deque<TMeteredDataSample> mMeteredDataSamples;
+    mutable uint64_t mMeteredDataSamplesDropped = 0;   ///< Oldest samples overwritten since the last read
+    Scheduler::TTaskId mSamplingTask = 0;
+
+    // Configuration file hot reload
+    uint32_t mConfigWatchPeriod = 0;            ///< Time in ms between 2 checks of the configuration file: 0 to disable
+    std::unique_ptr<ConfigWatcher> mConfigWatcher;
+    Json::Value mWatchedSettings;               ///< Settings of the configuration file at the last reload
+    Scheduler::TTaskId mConfigWatchTask = 0;
 
     // Debug parameters
     spdlog::level::level_enum mDebugMessageLevel;
 
-    // User accessible parameters
-    const std::map<ParameterKey, std::string> mParameterKeyMap = {
-    #   define PARAMETERKEY_ITEM(id) {id, #id},
-    #   include "accelize/drm/ParameterKey.def"
-    #   undef PARAMETERKEY_ITEM
-        {ParameterKeyCount, "ParameterKeyCount"}
-    };
-
 
     Impl( const std::string& conf_file_path,
-          const std::string& cred_file_path )
+          const std::string& cred_file_path,
+          std::shared_ptr<const DrmConfig> config = nullptr )
     {
         // Basic logging setup
         initLog();
 
-        Json::Value conf_json;
-
         mSecurityStop = false;
         mIsLockedToDrm = false;
 
         mLicenseCounter = 0;
         mLicenseDuration = 0;
 
-        mConfFilePath = conf_file_path;
-        mCredFilePath = cred_file_path;
-
         mFrequencyInit = 0;
         mFrequencyCurr = 0;
 
         mDebugMessageLevel = spdlog::level::trace;
 
+        registerMetrics();
+
         // Parse configuration file
-        conf_json = parseJsonFile( conf_file_path );
+        if ( !config )
+            config = DrmConfig::load( conf_file_path, cred_file_path );
+        mConfig = config;
 
         try {
-            Json::Value param_lib = JVgetOptional( conf_json, "settings", Json::objectValue );
+            const Json::Value& param_lib = mConfig->settings;
             if ( param_lib != Json::nullValue ) {
                 // Console logging
                 sLogConsoleVerbosity = static_cast<spdlog::level::level_enum>( JVgetOptional(
@@ -244,58 +400,96 @@ protected:
                 sLogServiceRotatingNum = JVgetOptional( param_lib, "log_service_rotating_num",
                         Json::intValue, (int)sLogServiceRotatingNum ).asInt();
 
+                // Asynchronous logging
+                sLogAsync = JVgetOptional( param_lib, "log_async", Json::booleanValue, sLogAsync ).asBool();
+                sLogAsyncQueueSize = JVgetOptional( param_lib, "log_async_queue_size",
+                        Json::uintValue, (uint32_t)sLogAsyncQueueSize ).asUInt();
+                sLogAsyncOverflowPolicy = JVgetOptional( param_lib, "log_async_overflow_policy",
+                        Json::stringValue, sLogAsyncOverflowPolicy ).asString();
+                if ( sLogAsyncQueueSize == 0 )
+                    Throw( DRM_BadArg, "log_async_queue_size must not be 0" );
+                if ( ( sLogAsyncOverflowPolicy != "block" ) && ( sLogAsyncOverflowPolicy != "overrun_oldest" ) )
+                    Throw( DRM_BadArg, "Unsupported log_async_overflow_policy '{}': must be 'block' or 'overrun_oldest'",
+                            sLogAsyncOverflowPolicy );
+
                 // Frequency detection
-                mFrequencyDetectionPeriod = JVgetOptional( param_lib, "frequency_detection_period",
-                        Json::uintValue, mFrequencyDetectionPeriod).asUInt();
-                mFrequencyDetectionThreshold = JVgetOptional( param_lib, "frequency_detection_threshold",
-                        Json::uintValue, mFrequencyDetectionThreshold).asDouble();
+                mRuntimeSettings.frequency_detection_period = JVgetOptional( param_lib, "frequency_detection_period",
+                        Json::uintValue, mRuntimeSettings.frequency_detection_period).asUInt();
+                mRuntimeSettings.frequency_detection_threshold = JVgetOptional( param_lib, "frequency_detection_threshold",
+                        Json::uintValue, mRuntimeSettings.frequency_detection_threshold).asDouble();
 
                 // Others
-                mWSRetryPeriodLong = JVgetOptional( param_lib, "ws_retry_period_long",
-                        Json::uintValue, mWSRetryPeriodLong).asUInt();
-                mWSRetryPeriodShort = JVgetOptional( param_lib, "ws_retry_period_short",
-                        Json::uintValue, mWSRetryPeriodShort).asUInt();
-                mWSRequestTimeout = JVgetOptional( param_lib, "ws_request_timeout",
-                        Json::uintValue, mWSRequestTimeout).asUInt();
-                if ( mWSRequestTimeout == 0 )
-                    Throw( DRM_BadArg, "ws_request_timeout must not be 0");
-            }
-            if ( mWSRetryPeriodLong <= mWSRetryPeriodShort )
-                Throw( DRM_BadArg, "ws_retry_period_long ({}) must be greater than ws_retry_period_short ({})",
-                        mWSRetryPeriodLong, mWSRetryPeriodShort );
+                mRuntimeSettings.ws_retry_period_long = JVgetOptional( param_lib, "ws_retry_period_long",
+                        Json::uintValue, mRuntimeSettings.ws_retry_period_long).asUInt();
+                mRuntimeSettings.ws_retry_period_short = JVgetOptional( param_lib, "ws_retry_period_short",
+                        Json::uintValue, mRuntimeSettings.ws_retry_period_short).asUInt();
+                mRuntimeSettings.ws_request_timeout = JVgetOptional( param_lib, "ws_request_timeout",
+                        Json::uintValue, mRuntimeSettings.ws_request_timeout).asUInt();
+                mWSRetryPolicyName = JVgetOptional( param_lib, "ws_retry_policy",
+                        Json::stringValue, mWSRetryPolicyName).asString();
+                mWSRetryMaxAttempts = JVgetOptional( param_lib, "ws_retry_max_attempts",
+                        Json::uintValue, mWSRetryMaxAttempts).asUInt();
+                mWSCircuitBreakerThreshold = JVgetOptional( param_lib, "ws_circuit_breaker_threshold",
+                        Json::uintValue, mWSCircuitBreakerThreshold).asUInt();
+                mWSCircuitBreakerCooldown = JVgetOptional( param_lib, "ws_circuit_breaker_cooldown",
+                        Json::uintValue, mWSCircuitBreakerCooldown).asUInt();
+                mMeteringJournalDir = JVgetOptional( param_lib, "metering_journal_dir",
+                        Json::stringValue, mMeteringJournalDir).asString();
+                mMetricsFilePath = JVgetOptional( param_lib, "metrics_file_path",
+                        Json::stringValue, mMetricsFilePath).asString();
+                mMetricsFilePeriod = JVgetOptional( param_lib, "metrics_file_period",
+                        Json::uintValue, mMetricsFilePeriod).asUInt();
+                if ( mMetricsFilePeriod == 0 )
+                    Throw( DRM_BadArg, "metrics_file_period must not be 0");
+                mEventLogPath = JVgetOptional( param_lib, "event_log_path",
+                        Json::stringValue, mEventLogPath).asString();
+                mEventLogRotatingSize = JVgetOptional( param_lib, "event_log_rotating_size",
+                        Json::uintValue, (uint32_t)mEventLogRotatingSize).asUInt();
+                mEventLogRotatingNum = JVgetOptional( param_lib, "event_log_rotating_num",
+                        Json::uintValue, (uint32_t)mEventLogRotatingNum).asUInt();
+                mActivatorBaseAddr = JVgetOptional( param_lib, "activator_base_addr",
+                        Json::uintValue, mActivatorBaseAddr).asUInt();
+                mActivatorStride = JVgetOptional( param_lib, "activator_stride",
+                        Json::uintValue, mActivatorStride).asUInt();
+                mActivatorsStatusPeriod = JVgetOptional( param_lib, "activators_status_period",
+                        Json::uintValue, mActivatorsStatusPeriod).asUInt();
+                mMeteredDataSamplingPeriod = JVgetOptional( param_lib, "metered_data_sampling_period",
+                        Json::uintValue, mMeteredDataSamplingPeriod).asUInt();
+                mMeteredDataSamplingSize = JVgetOptional( param_lib, "metered_data_sampling_size",
+                        Json::uintValue, mMeteredDataSamplingSize).asUInt();
+                if ( mMeteredDataSamplingSize == 0 )
+                    Throw( DRM_BadArg, "metered_data_sampling_size must not be 0");
+                mThreadSettings.update( param_lib );
+                mAsyncErrorQueueSize = JVgetOptional( param_lib, "async_error_queue_size",
+                        Json::uintValue, mAsyncErrorQueueSize).asUInt();
+                mConfigWatchPeriod = JVgetOptional( param_lib, "config_watch_period",
+                        Json::uintValue, mConfigWatchPeriod).asUInt();
+            }
+            mRetryPolicy = RetryPolicy::create( mWSRetryPolicyName, mWSRetryMaxAttempts );
+            mCircuitBreaker.configure( mWSCircuitBreakerThreshold, mWSCircuitBreakerCooldown );
+            mRuntimeSettings.validate();
 
             // Customize logging configuration
             updateLog();
-
-            // Design configuration
-            Json::Value conf_design = JVgetOptional( conf_json, "design", Json::objectValue );
-            if ( !conf_design.empty() ) {
-                mUDID = JVgetOptional( conf_design, "udid", Json::stringValue, "" ).asString();
-                mBoardType = JVgetOptional( conf_design, "boardType", Json::stringValue, "" ).asString();
-            }
-
-            // Licensing configuration
-            Json::Value conf_licensing = JVgetRequired( conf_json, "licensing", Json::objectValue );
-            // Get licensing mode
-            bool is_nodelocked = JVgetOptional( conf_licensing, "nodelocked", Json::booleanValue, false ).asBool();
-            if ( is_nodelocked ) {
-                // If this is a node-locked license, get the license path
-                mNodeLockLicenseDirPath = JVgetRequired( conf_licensing, "license_dir", Json::stringValue ).asString();
-                mLicenseType = eLicenseType::NODE_LOCKED;
-                Debug( "Configuration file specifies a Node-locked license" );
-            } else {
-                Debug( "Configuration file specifies a floating/metered license" );
-                // Get DRM frequency
-                Json::Value conf_drm = JVgetRequired( conf_json, "drm", Json::objectValue );
-                mFrequencyInit = JVgetRequired( conf_drm, "frequency_mhz", Json::intValue ).asUInt();
-                mFrequencyCurr = mFrequencyInit;
-            }
+            if ( !mEventLogPath.empty() )
+                mEventLog = std::make_shared<EventLog>( mEventLogPath, mEventLogRotatingSize, mEventLogRotatingNum );
 
         } catch( Exception &e ) {
             if ( e.getErrCode() != DRM_BadFormat )
                 throw;
             Throw( DRM_BadFormat, "Error in configuration file '{}: {}", conf_file_path, e.what() );
         }
+
+        // Design and licensing configuration
+        mUDID = mConfig->udid;
+        mBoardType = mConfig->board_type;
+        if ( mConfig->nodelocked ) {
+            mNodeLockLicenseDirPath = mConfig->license_dir;
+            mLicenseType = eLicenseType::NODE_LOCKED;
+        } else {
+            mFrequencyInit = mConfig->frequency_mhz;
+            mFrequencyCurr = mFrequencyInit;
+        }
     }
 
     void initLog() {
@@ -307,8 +501,15 @@ protected:
             console_sink->set_pattern( sLogConsoleFormat );
             sinks.push_back( console_sink );
 
-            sLogger = std::make_shared<spdlog::logger>( "drmlib_logger", sinks.begin(), sinks.end() );
+            // Keep logging asynchronously if other instances do
+            std::lock_guard<std::mutex> lock( sLogAsyncMutex );
+            if ( sLogThreadPool )
+                sLogger = std::make_shared<spdlog::async_logger>( "drmlib_logger", sinks.begin(), sinks.end(),
+                        sLogThreadPool );
+            else
+                sLogger = std::make_shared<spdlog::logger>( "drmlib_logger", sinks.begin(), sinks.end() );
             sLogger->set_level( sLogConsoleVerbosity );
+            sLogger->flush_on( spdlog::level::err );
             spdlog::set_default_logger( sLogger );
         }
         catch( const spdlog::spdlog_ex& ex ) {
@@ -366,20 +567,65 @@ protected:
                 createFileLog( sLogServicePath, sLogServiceType, sLogServiceVerbosity,
                                sLogServiceFormat, sLogServiceRotatingSize, sLogServiceRotatingNum );
             }
+
+            if ( sLogAsync )
+                setAsyncLog();
         }
         catch( const spdlog::spdlog_ex& ex ) {
             std::cout << "Failed to update logging settings: " << ex.what() << std::endl;
         }
     }
 
+    // Replace the logger by an asynchronous logger with the same sinks: messages are written
+    // by a background thread so that a slow disk never stalls the caller.
+    // The thread pool is shared by all instances: it is created by the first one and
+    // destroyed by the last one, so the queue size is the one of the first instance.
+    void setAsyncLog() {
+        auto overflow_policy = ( sLogAsyncOverflowPolicy == "overrun_oldest" ) ?
+                spdlog::async_overflow_policy::overrun_oldest : spdlog::async_overflow_policy::block;
+        std::lock_guard<std::mutex> lock( sLogAsyncMutex );
+        if ( !sLogThreadPool )
+            sLogThreadPool = std::make_shared<spdlog::details::thread_pool>( sLogAsyncQueueSize, 1 );
+        if ( !mLogAsyncUser ) {
+            mLogAsyncUser = true;
+            sLogAsyncUsers ++;
+        }
+        auto logger = std::make_shared<spdlog::async_logger>( "drmlib_logger",
+                sLogger->sinks().begin(), sLogger->sinks().end(), sLogThreadPool, overflow_policy );
+        logger->set_level( sLogger->level() );
+        logger->flush_on( spdlog::level::err );
+        sLogger = logger;
+        spdlog::set_default_logger( sLogger );
+        Debug( "Asynchronous logging enabled with a queue of {} messages and '{}' overflow policy",
+                sLogAsyncQueueSize, sLogAsyncOverflowPolicy );
+    }
+
     void uninitLog() {
-        if ( sLogger )
+        if ( !sLogger )
+            return;
+        sLogger->flush();
+        std::lock_guard<std::mutex> lock( sLogAsyncMutex );
+        if ( !mLogAsyncUser )
+            return;
+        mLogAsyncUser = false;
+        sLogAsyncUsers --;
+        if ( ( sLogAsyncUsers == 0 ) && sLogThreadPool ) {
+            // Last user: switch back to a synchronous logger, then wait for the background thread
+            // to write all pending messages: the thread pool is destroyed once its queue is empty
+            auto logger = std::make_shared<spdlog::logger>( "drmlib_logger",
+                    sLogger->sinks().begin(), sLogger->sinks().end() );
+            logger->set_level( sLogger->level() );
+            logger->flush_on( spdlog::level::err );
+            sLogger = logger;
+            spdlog::set_default_logger( sLogger );
+            sLogThreadPool.reset();
             sLogger->flush();
+        }
     }
 
     uint32_t getMailboxSize() const {
         uint32_t roSize, rwSize;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeMailBoxFilePageRegister() );
         checkDRMCtlrRet( getDrmController().readMailboxFileSizeRegister( roSize, rwSize ) );
         Debug2( "Read Mailbox size: {}", rwSize );
@@ -391,7 +637,7 @@ protected:
         uint32_t roSize, rwSize;
         std::vector<uint32_t> roData, rwData;
 
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeMailBoxFilePageRegister() );
         checkDRMCtlrRet( getDrmController().readMailboxFileRegister( roSize, rwSize, roData, rwData) );
 
@@ -408,7 +654,7 @@ protected:
         uint32_t roSize, rwSize;
         std::vector<uint32_t> roData, rwData;
 
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeMailBoxFilePageRegister() );
         checkDRMCtlrRet( getDrmController().readMailboxFileRegister( roSize, rwSize, roData, rwData) );
 
@@ -430,7 +676,7 @@ protected:
         uint32_t roSize, rwSize;
         std::vector<uint32_t> roData, rwData;
 
-        std::lock_guard<std::recursive_mutex> lockk( mDrmControllerMutex );
+        TControllerLock lockk( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeMailBoxFilePageRegister() );
         checkDRMCtlrRet( getDrmController().readMailboxFileRegister( roSize, rwSize, roData, rwData) );
 
@@ -446,7 +692,7 @@ protected:
         uint32_t roSize, rwSize;
         std::vector<uint32_t> roData, rwData;
 
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeMailBoxFilePageRegister() );
         checkDRMCtlrRet( getDrmController().readMailboxFileRegister( roSize, rwSize, roData, rwData) );
         if ( index >= rwData.size() )
@@ -472,17 +718,18 @@ protected:
     }
 
     static uint32_t getDrmRegisterOffset( const std::string& regName ) {
-        if ( regName == "DrmPageRegister" )
-            return 0;
-        if ( regName.substr( 0, 15 ) == "DrmRegisterLine" )
-            return (uint32_t)std::stoul( regName.substr( 15 ) ) * 4 + 4;
-        Unreachable( "Unsupported regName argument: ", regName ); //LCOV_EXCL_LINE
+        return HwSnapshot::getRegisterOffset( regName );
     }
 
     unsigned int readDrmRegister( const std::string& regName, unsigned int& value ) const {
         int ret = 0;
-        ret = f_read_register( getDrmRegisterOffset( regName ), &value );
+        uint32_t offset = getDrmRegisterOffset( regName );
+        mMetrics.registerReads.inc();
+        DRM_TRACE_ARGS( read_register_entry, offset );
+        ret = f_read_register( offset, &value );
+        DRM_TRACE_ARGS( read_register_return, offset, value, ret );
         if ( ret != 0 ) {
+            mMetrics.registerErrors.inc();
             Error( "Error in read register callback, errcode = {}", ret );
             return (uint32_t)(-1);
         }
@@ -492,8 +739,15 @@ protected:
 
     unsigned int writeDrmRegister( const std::string& regName, unsigned int value ) const {
         int ret = 0;
-        ret = f_write_register( getDrmRegisterOffset( regName ), value );
+        mMetrics.registerWrites.inc();
+        if ( regName == "DrmPageRegister" )
+            mMetrics.pageSwitches.inc();
+        uint32_t offset = getDrmRegisterOffset( regName );
+        DRM_TRACE_ARGS( write_register_entry, offset, value );
+        ret = f_write_register( offset, value );
+        DRM_TRACE_ARGS( write_register_return, offset, value, ret );
         if ( ret ) {
+            mMetrics.registerErrors.inc();
             Error( "Error in write register callback, errcode = {}", ret );
             return (uint32_t)(-1);
         }
@@ -508,7 +762,7 @@ protected:
 
     void lockDrmToInstance() {
         return;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         uint32_t isLocked = readMailbox( eMailboxOffset::MB_LOCK_DRM );
         if ( isLocked )
             Throw( DRM_BadUsage, "Another instance of the DRM Manager is currently owning the HW" );
@@ -519,7 +773,7 @@ protected:
 
     void unlockDrmToInstance() {
         return;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         if ( !mIsLockedToDrm )
             return;
         uint32_t isLocked = readMailbox( eMailboxOffset::MB_LOCK_DRM );
@@ -591,6 +845,7 @@ protected:
 
         // Save header information
         mHeaderJsonRequest = getMeteringHeader();
+        mRequestTemplate.setHeader( mHeaderJsonRequest );
 
         // If node-locked license is requested, create license request file
         if ( mLicenseType == eLicenseType::NODE_LOCKED ) {
@@ -599,28 +854,204 @@ protected:
             if ( !isDir( mNodeLockLicenseDirPath ) )
                 Throw( DRM_BadArg,
                         "License directory path '{}' specified in configuration file '{}' is not existing on file system",
-                        mNodeLockLicenseDirPath, mConfFilePath );
+                        mNodeLockLicenseDirPath, mConfig->conf_file_path );
 
             // If a floating/metering session is still running, try to close it gracefully.
             if ( isDrmCtrlInMetering() && isSessionRunning() ) {
                 Debug( "A floating/metering session is still pending: trying to close it gracefully before switching to nodelocked license." );
                 mHeaderJsonRequest["mode"] = (uint8_t)eLicenseType::METERED;
+                mRequestTemplate.setHeader( mHeaderJsonRequest );
                 try {
-                    mWsClient.reset( new DrmWSClient( mConfFilePath, mCredFilePath ) );
+                    createWSClient();
                     stopSession();
                 } catch( const Exception& e ) {
                     Debug( "Failed to stop gracefully the pending session because: {}", e.what() );
                 }
                 mHeaderJsonRequest["mode"] = (uint8_t)eLicenseType::NODE_LOCKED;
+                mRequestTemplate.setHeader( mHeaderJsonRequest );
             }
 
             // Create license request file
             createNodelockedLicenseRequestFile();
         } else {
-            mWsClient.reset( new DrmWSClient( mConfFilePath, mCredFilePath ) );
+            createWSClient();
+
+            // Replay the metering left by previous processes
+            if ( !mMeteringJournalDir.empty() ) {
+                mMeteringJournal.reset( new MeteringJournal( mMeteringJournalDir ) );
+                startJournalUploadThread();
+            }
+        }
+    }
+
+    void registerMetrics() {
+        mMetricsRegistry.add( "drm_register_reads_total", "DRM Controller register reads", mMetrics.registerReads );
+        mMetricsRegistry.add( "drm_register_writes_total", "DRM Controller register writes", mMetrics.registerWrites );
+        mMetricsRegistry.add( "drm_register_errors_total", "Failed register read and write callbacks",
+                mMetrics.registerErrors );
+        mMetricsRegistry.add( "drm_page_switches_total", "DRM Controller page register writes", mMetrics.pageSwitches );
+        mMetricsRegistry.add( "drm_poll_iterations_total", "Iterations of the license continuity thread",
+                mMetrics.pollIterations );
+        mMetricsRegistry.add( "drm_licenses_installed_total", "Licenses installed on the DRM Controller",
+                mMetrics.licensesInstalled );
+        mMetricsRegistry.add( "drm_license_renewal_latency_ms", "Time to extract metering, get and install a new license",
+                mMetrics.renewalLatency );
+        mMetricsRegistry.add( "drm_license_time_left_at_renewal_seconds",
+                "Time left on the current license when the next one is installed", mMetrics.timeLeftAtRenewal );
+        mMetricsRegistry.add( "drm_license_wakeup_delay_us",
+                "Delay between the expiration of the current license and the check of the DRM Controller readiness",
+                mMetrics.wakeupDelay );
+        mMetricsRegistry.add( "drm_license_early_wakeups_total",
+                "Checks of the DRM Controller readiness done before the current license expired",
+                mMetrics.earlyWakeups );
+        mMetricsRegistry.add( "drm_async_errors_coalesced_total",
+                "Asynchronous errors coalesced with an identical queued error", mMetrics.asyncErrorsCoalesced );
+        mMetricsRegistry.add( "drm_async_errors_dropped_total", "Asynchronous errors dropped because the queue was full",
+                mMetrics.asyncErrorsDropped );
+        mMetricsRegistry.add( "drm_housekeeping_skipped_total",
+                "Periodic tasks skipped because the DRM Controller was busy", mMetrics.housekeepingSkipped );
+        mMetricsRegistry.add( "drm_controller_lock_wait_us", "Time waiting for the DRM Controller lock",
+                mMetrics.lockWait );
+        mMetricsRegistry.add( "drm_controller_lock_hold_us", "Time holding the DRM Controller lock",
+                mMetrics.lockHold );
+        mDrmControllerMutex.setWaitTimeHistogram( &mMetrics.lockWait );
+        mDrmControllerMutex.setHoldTimeHistogram( &mMetrics.lockHold );
+    }
+
+    Json::Value getMetrics() const {
+        Json::Value node = mMetricsRegistry.toJson();
+        node["ws_oauth2"] = mOAuth2Statistics->toJson();
+        node["ws_license"] = mLicenseStatistics->toJson();
+        node["drm_controller_lock"] = mDrmControllerMutex.toJson();
+        return node;
+    }
+
+    std::string getPrometheusMetrics() const {
+        std::string out;
+        mMetricsRegistry.appendPrometheus( out );
+        const std::vector<std::pair<std::string, const WSRequestStatistics*>> ws_stats = {
+                { "oauth2", mOAuth2Statistics.get() }, { "license", mLicenseStatistics.get() } };
+        appendPrometheusHeader( out, "drm_ws_requests_total", "Web Service responses by code", "counter" );
+        for( const auto& ws: ws_stats ) {
+            for( const auto& it: ws.second->getResponseCodes() )
+                out += fmt::format( "drm_ws_requests_total{{ws=\"{}\",code=\"{}\"}} {}\n", ws.first, it.first, it.second );
+        }
+        appendPrometheusHeader( out, "drm_ws_retries_total", "Retried Web Service errors by code", "counter" );
+        for( const auto& ws: ws_stats ) {
+            for( const auto& it: ws.second->getRetryableErrors() )
+                out += fmt::format( "drm_ws_retries_total{{ws=\"{}\",code=\"{}\"}} {}\n", ws.first, it.first, it.second );
+        }
+        appendPrometheusHeader( out, "drm_ws_request_duration_ms", "Web Service request duration by phase", "histogram" );
+        for( const auto& ws: ws_stats ) {
+            for( const auto& phase: ws.second->getPhaseTimes() )
+                phase.second->appendPrometheus( out, "drm_ws_request_duration_ms",
+                        fmt::format( "ws=\"{}\",phase=\"{}\"", ws.first, phase.first ) );
+        }
+        const auto holders = mDrmControllerMutex.getTopHolders();
+        appendPrometheusHeader( out, "drm_controller_lock_acquisitions_total",
+                "DRM Controller lock acquisitions by operation", "counter" );
+        for( const auto& it: holders )
+            out += fmt::format( "drm_controller_lock_acquisitions_total{{operation=\"{}\"}} {}\n", it.first, it.second.count );
+        appendPrometheusHeader( out, "drm_controller_lock_wait_us_total",
+                "Time waiting for the DRM Controller lock by operation", "counter" );
+        for( const auto& it: holders )
+            out += fmt::format( "drm_controller_lock_wait_us_total{{operation=\"{}\"}} {}\n", it.first, it.second.waitTotal );
+        appendPrometheusHeader( out, "drm_controller_lock_hold_us_total",
+                "Time holding the DRM Controller lock by operation", "counter" );
+        for( const auto& it: holders )
+            out += fmt::format( "drm_controller_lock_hold_us_total{{operation=\"{}\"}} {}\n", it.first, it.second.holdTotal );
+        appendPrometheusHeader( out, "drm_controller_lock_max_recursion_depth",
+                "Maximum recursion depth of the DRM Controller lock", "gauge" );
+        out += fmt::format( "drm_controller_lock_max_recursion_depth {}\n", mDrmControllerMutex.getMaxRecursionDepth() );
+        return out;
+    }
+
+    // Log the operations which held the DRM Controller lock the longest
+    void logLockTopHolders( const size_t& max_count = 10 ) const {
+        if ( !isLogEnabled( spdlog::level::debug ) )
+            return;
+        const auto holders = mDrmControllerMutex.getTopHolders();
+        Debug( "Top DRM Controller lock holders (max recursion depth = {}):",
+                mDrmControllerMutex.getMaxRecursionDepth() );
+        for( size_t i = 0; ( i < holders.size() ) && ( i < max_count ); i++ ) {
+            const auto& stats = holders[i].second;
+            Debug( "  {}: held {} times, hold total = {} us, hold max = {} us, wait total = {} us, wait max = {} us",
+                    holders[i].first, stats.count, stats.holdTotal, stats.holdMax, stats.waitTotal, stats.waitMax );
+        }
+    }
+
+    void writeMetricsFile() const {
+        // The Prometheus textfile collector requires files to be written atomically
+        std::string tmp_path = fmt::format( "{}.{}.tmp", mMetricsFilePath, getpid() );
+        {
+            std::ofstream ofs( tmp_path, std::ios::trunc );
+            ofs << getPrometheusMetrics();
+            if ( !ofs.good() ) {
+                Warning( "Failed to write metrics file {}", tmp_path );
+                return;
+            }
+        }
+        if ( rename( tmp_path.c_str(), mMetricsFilePath.c_str() ) != 0 )
+            Warning( "Failed to update metrics file {}: {}", mMetricsFilePath, strerror( errno ) );
+    }
+
+    void startMetricsThread() {
+        if ( mMetricsFilePath.empty() )
+            return;
+        Debug( "Scheduling the write of metrics to {} every {} seconds", mMetricsFilePath, mMetricsFilePeriod );
+        mMetricsTask = mScheduler->schedulePeriodic( TClock::now(), std::chrono::seconds( mMetricsFilePeriod ),
+                [ this ]() { writeMetricsFile(); } );
+    }
+
+    void stopMetricsThread() {
+        if ( !mMetricsTask )
+            return;
+        mScheduler->cancel( mMetricsTask );
+        mMetricsTask = 0;
+        // Last update
+        writeMetricsFile();
+        Debug( "Metrics file write unscheduled" );
+    }
+
+    void createWSClient() {
+        if ( mGroup ) {
+            mWsClient = mGroup->ws_client;
+            mOAuth2Statistics = mGroup->oauth2_statistics;
+            mLicenseStatistics = mGroup->license_statistics;
+            if ( mEventLog && !mWsClient->hasEventLog() )
+                mWsClient->setEventLog( mEventLog );
+            return;
+        }
+        mWsClient.reset( new DrmWSClient( *mConfig ) );
+        mWsClient->setStatistics( mOAuth2Statistics, mLicenseStatistics );
+        mWsClient->setEventLog( mEventLog );
+    }
+
+    void logEvent( const std::string& event, const Json::Value& fields = Json::objectValue ) {
+        if ( mEventLog )
+            mEventLog->write( event, fields );
+    }
+
+    void setSessionID( const std::string& session_id ) {
+        mSessionID = session_id;
+        if ( mEventLog )
+            mEventLog->setSessionID( session_id );
+    }
+
+    // Report an error of a background thread to the user callback
+    void reportAsyncError( const std::string& message ) {
+        if ( mEventLog ) {
+            Json::Value fields;
+            fields["message"] = message;
+            mEventLog->write( "async_error", fields );
         }
+        if ( mAsyncErrorDispatcher )
+            mAsyncErrorDispatcher->push( message );
+        else
+            f_asynch_error( message );
     }
 
+
     void checkSessionIDFromWS( const Json::Value license_json ) {
         std::string ws_sessionID = license_json["metering"]["sessionId"].asString();
         if ( !mSessionID.empty() && ( mSessionID != ws_sessionID ) ) {
@@ -629,24 +1060,97 @@ protected:
         }
     }
 
-    void checkSessionIDFromDRM( const Json::Value license_json ) {
-        std::string ws_sessionID = license_json["sessionId"].asString();
-        if ( !mSessionID.empty() && ( mSessionID != ws_sessionID ) ) {
-            Unreachable( "Session ID mismatch: DRM gives '", ws_sessionID, "' but expect '",
+    void checkSessionIDFromDRM( const std::string& drm_sessionID ) {
+        if ( !mSessionID.empty() && ( mSessionID != drm_sessionID ) ) {
+            Unreachable( "Session ID mismatch: DRM gives '", drm_sessionID, "' but expect '",
                     mSessionID, "'"); //LCOV_EXCL_LINE
         }
     }
 
     void getNumActivator( uint32_t& value ) const {
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeRegistersPageRegister() );
         checkDRMCtlrRet( getDrmController().readNumberOfDetectedIpsStatusRegister( value ) );
     }
 
+    // Read the status register of all activators in one pass: the caller must own mActivatorsStatusMtx.
+    // The DRM Controller is not accessed here: a caller which locks it must do so before mActivatorsStatusMtx
+    void refreshActivatorsStatus() const {
+        std::vector<uint32_t> values( mNumActivators, 0 );
+        for( uint32_t i = 0; i < values.size(); i++ ) {
+            uint32_t offset = mActivatorBaseAddr + i * mActivatorStride;
+            if ( f_read_register( offset, &values[i] ) )
+                Throw( DRM_ExternFail, "Failed to read status register of activator #{} at offset 0x{:X}",
+                        i, offset );
+        }
+        mActivatorsStatus = std::move( values );
+        mActivatorsStatusTime = TClock::now();
+    }
+
+    // Return {"activators": [{"status": <register>, "active": <bit 0>, "ready": <bit 1>}, ...],
+    //         "all_active": <bool>, "age_ms": <time since the registers were read>}
+    Json::Value getActivatorsStatus() const {
+        std::lock_guard<std::mutex> lock( mActivatorsStatusMtx );
+        if ( ( mActivatorsStatusPeriod == 0 ) || ( mActivatorsStatusTime == TClock::time_point() ) )
+            refreshActivatorsStatus();
+        Json::Value node;
+        Json::Value& activators = node["activators"];
+        activators = Json::arrayValue;
+        bool all_active = true;
+        for( const uint32_t& value: mActivatorsStatus ) {
+            Json::Value activator;
+            activator["status"] = value;
+            activator["active"] = ( value & 1 ) == 1;
+            activator["ready"] = ( ( value >> 1 ) & 1 ) == 1;
+            all_active &= activator["active"].asBool();
+            activators.append( activator );
+        }
+        node["all_active"] = all_active;
+        node["age_ms"] = (Json::UInt64)std::chrono::duration_cast<std::chrono::milliseconds>(
+                TClock::now() - mActivatorsStatusTime ).count();
+        return node;
+    }
+
+    // Periodic tasks share the scheduler worker with the other managers: skip a run rather than wait
+    // for a DRM Controller busy with another operation
+    bool tryLockForHousekeeping( const char* operation ) {
+        if ( mDrmControllerMutex.try_lock( operation ) )
+            return true;
+        mMetrics.housekeepingSkipped.inc();
+        Debug2( "DRM Controller is busy: {} skipped", operation );
+        return false;
+    }
+
+    void startActivatorsStatusThread() {
+        if ( mActivatorsStatusPeriod == 0 )
+            return;
+        Debug( "Scheduling the read of activators status every {} ms", mActivatorsStatusPeriod );
+        mActivatorsStatusTask = mScheduler->schedulePeriodic( TClock::now(),
+                std::chrono::milliseconds( mActivatorsStatusPeriod ), [ this ]() {
+            try {
+                if ( !tryLockForHousekeeping( "refreshActivatorsStatus" ) )
+                    return;
+                std::lock_guard<TControllerMutex> lock( mDrmControllerMutex, std::adopt_lock );
+                std::lock_guard<std::mutex> status_lock( mActivatorsStatusMtx );
+                refreshActivatorsStatus();
+            } catch( const std::exception& e ) {
+                Warning( "Failed to refresh activators status: {}", e.what() );
+            }
+        });
+    }
+
+    void stopActivatorsStatusThread() {
+        if ( !mActivatorsStatusTask )
+            return;
+        mScheduler->cancel( mActivatorsStatusTask );
+        mActivatorsStatusTask = 0;
+        Debug( "Activators status read unscheduled" );
+    }
+
     uint64_t getTimerCounterValue() const {
         uint32_t licenseTimerCounterMsb(0), licenseTimerCounterLsb(0);
         uint64_t licenseTimerCounter(0);
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().sampleLicenseTimerCounter( licenseTimerCounterMsb,
                 licenseTimerCounterLsb ) );
         licenseTimerCounter = licenseTimerCounterMsb;
@@ -656,52 +1160,250 @@ protected:
     }
 
     std::string getDrmPage( uint32_t page_index ) const {
-        uint32_t value;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
-        writeDrmRegister( "DrmPageRegister", page_index );
-        std::string str = fmt::format( "DRM Page {}  registry:\n", page_index );
-        for( uint32_t r=0; r < NB_MAX_REGISTER; r++ ) {
-            f_read_register( r*4, &value );
-            str += fmt::format( "\tRegister @0x{:02X}: 0x{:08X} ({:d})\n", r*4, value, value );
+        uint32_t values[NB_MAX_REGISTER];
+        {
+            TControllerLock lock( mDrmControllerMutex, __func__ );
+            writeDrmRegister( "DrmPageRegister", page_index );
+            for( uint32_t r=0; r < NB_MAX_REGISTER; r++ )
+                f_read_register( r*4, &values[r] );
         }
+        std::string str = fmt::format( "DRM Page {}  registry:\n", page_index );
+        str.reserve( str.size() + NB_MAX_REGISTER * 48 );
+        for( uint32_t r=0; r < NB_MAX_REGISTER; r++ )
+            str += fmt::format( "\tRegister @0x{:02X}: 0x{:08X} ({:d})\n", r*4, values[r], values[r] );
         return str;
     }
 
+    // Read all DRM Controller pages in one pass
+    HwSnapshot getHwSnapshot() const {
+        HwSnapshot snapshot;
+        DrmControllerLibrary::tDrmReadRegisterFunction read_register = std::bind(
+                &DrmManager::Impl::readDrmRegister, this, std::placeholders::_1, std::placeholders::_2 );
+        DrmControllerLibrary::tDrmWriteRegisterFunction write_register = std::bind(
+                &DrmManager::Impl::writeDrmRegister, this, std::placeholders::_1, std::placeholders::_2 );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
+        if ( mHwReportLayout.empty() )
+            mHwReportLayout = HwSnapshot::getReportLayout( read_register, write_register );
+        snapshot.capture( read_register, write_register, mHwReportLayout );
+        return snapshot;
+    }
+
     std::string getDrmReport() const {
-        std::stringstream ss;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
-        getDrmController().printHwReport( ss );
-        return ss.str();
+        // Render the report out of the DRM Controller lock
+        return getHwSnapshot().toText();
     }
 
-    uint64_t getMeteringData() const {
-        uint32_t numberOfDetectedIps;
-        std::string saasChallenge;
-        std::vector<std::string> meteringFile;
-        uint64_t meteringData = 0;
-
-        Debug2( "Get metering data from session on DRM controller" );
-
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
-        if ( ( mLicenseType == eLicenseType::NODE_LOCKED ) || isLicenseActive() ) {
-            checkDRMCtlrRet( getDrmController().asynchronousExtractMeteringFile(
-                    numberOfDetectedIps, saasChallenge, meteringFile ) );
-            std::string meteringDataStr = meteringFile[2].substr( 16, 16 );
-            errno = 0;
-            meteringData = strtoull( meteringDataStr.c_str(), nullptr, 16 );
-            if ( errno )
-                Throw( DRM_CtlrError, "Could not convert string '{}' to unsigned long long.",
-                        meteringDataStr );
-            return meteringData;
-        } else {
+    // Read only the metered data counter: 2 registers of the metering file instead of the whole file,
+    // the SaaS challenge and their hexadecimal conversion
+    uint64_t getMeteringCounter() const {
+        // Global counter in the lower 64 bits of the 3rd 128 bits word of the metering file
+        static const std::string cCounterMsbRegister = "DrmRegisterLine10";
+        static const std::string cCounterLsbRegister = "DrmRegisterLine11";
+        uint32_t msb = 0, lsb = 0;
+        bool ready = false;
+
+        Debug2( "Get metering counter from session on DRM controller" );
+
+        TControllerLock lock( mDrmControllerMutex, __func__ );
+        if ( ( mLicenseType != eLicenseType::NODE_LOCKED ) && !isLicenseActive() )
             return 0;
+        checkDRMCtlrRet( getDrmController().writeMeteringExtractCommandRegister() );
+        checkDRMCtlrRet( getDrmController().waitAsynchronousMeteringReadyStatusRegister(
+                DRM_CONTROLLER_TIMEOUT_IN_MICRO_SECONDS, true, ready ) );
+        checkDRMCtlrRet( getDrmController().writeMeteringFilePageRegister() );
+        if ( readDrmRegister( cCounterMsbRegister, msb ) || readDrmRegister( cCounterLsbRegister, lsb ) )
+            Throw( DRM_CtlrError, "Failed to read the metering counter" );
+        checkDRMCtlrRet( getDrmController().writeNopCommandRegister() );
+        checkDRMCtlrRet( getDrmController().waitAsynchronousMeteringReadyStatusRegister(
+                DRM_CONTROLLER_TIMEOUT_IN_MICRO_SECONDS, false, ready ) );
+        return ( (uint64_t)msb << 32 ) | lsb;
+    }
+
+    void sampleMeteredData() const {
+        TMeteredDataSample sample( std::chrono::system_clock::now(), getMeteringCounter() );
+        std::lock_guard<std::mutex> lock( mMeteredDataSamplesMtx );
+        if ( mMeteredDataSamples.size() >= mMeteredDataSamplingSize ) {
+            mMeteredDataSamples.pop_front();
+            mMeteredDataSamplesDropped++;
+        }
+        mMeteredDataSamples.push_back( sample );
+    }
+
+    // Return and clear {"samples": [{"time": "<ISO 8601 UTC>", "value": <metered data>}, ...],
+    //                   "dropped": <samples overwritten since the last call>}
+    Json::Value popMeteredDataSamples() const {
+        std::deque<TMeteredDataSample> samples;
+        Json::Value node;
+        {
+            std::lock_guard<std::mutex> lock( mMeteredDataSamplesMtx );
+            samples.swap( mMeteredDataSamples );
+            node["dropped"] = (Json::UInt64)mMeteredDataSamplesDropped;
+            mMeteredDataSamplesDropped = 0;
+        }
+        Json::Value& samples_node = node["samples"];
+        samples_node = Json::arrayValue;
+        for( const auto& sample: samples ) {
+            Json::Value sample_node;
+            sample_node["time"] = getISO8601Time( sample.first );
+            sample_node["value"] = (Json::UInt64)sample.second;
+            samples_node.append( sample_node );
+        }
+        return node;
+    }
+
+    void startSamplingThread() {
+        if ( mMeteredDataSamplingPeriod == 0 )
+            return;
+        Debug( "Scheduling the sampling of metered data every {} ms", mMeteredDataSamplingPeriod );
+        mSamplingTask = mScheduler->schedulePeriodic( TClock::now(),
+                std::chrono::milliseconds( mMeteredDataSamplingPeriod ), [ this ]() {
+            try {
+                if ( !tryLockForHousekeeping( "sampleMeteredData" ) )
+                    return;
+                std::lock_guard<TControllerMutex> lock( mDrmControllerMutex, std::adopt_lock );
+                sampleMeteredData();
+            } catch( const std::exception& e ) {
+                Warning( "Failed to sample metered data: {}", e.what() );
+            }
+        });
+    }
+
+    void stopSamplingThread() {
+        if ( !mSamplingTask )
+            return;
+        mScheduler->cancel( mSamplingTask );
+        mSamplingTask = 0;
+        Debug( "Metered data sampling unscheduled" );
+    }
+
+    // Settings applied by a configuration file reload
+    static bool isRuntimeSetting( const std::string& name ) {
+        return ( name == "ws_retry_period_long" ) || ( name == "ws_retry_period_short" )
+                || ( name == "ws_request_timeout" ) || ( name == "log_verbosity" )
+                || ( name == "log_file_verbosity" ) || ( name == "frequency_detection_period" )
+                || ( name == "frequency_detection_threshold" );
+    }
+
+    RuntimeSettings getRuntimeSettings() const {
+        std::lock_guard<std::mutex> lock( mRuntimeSettingsMtx );
+        return mRuntimeSettings;
+    }
+
+    // Apply the change to a copy of the runtime settings and install it only if it is valid:
+    // concurrent updates are serialized so none of them is lost
+    template<class F>
+    RuntimeSettings updateRuntimeSettings( F&& update ) {
+        std::lock_guard<std::mutex> lock( mRuntimeSettingsMtx );
+        RuntimeSettings settings = mRuntimeSettings;
+        update( settings );
+        settings.validate();
+        mRuntimeSettings = settings;
+        return settings;
+    }
+
+    void reloadConfiguration() {
+        const std::string& conf_file_path = mConfig->conf_file_path;
+        std::shared_ptr<const DrmConfig> config;
+        try {
+            config = DrmConfig::load( conf_file_path, mConfig->cred_file_path );
+        } catch( const Exception& e ) {
+            Warning( "Configuration file '{}' not reloaded: {}", conf_file_path, e.what() );
+            return;
+        }
+        if ( !config->hasSameLicensing( *mConfig ) )
+            Warning( "Design, licensing and DRM sections of configuration file '{}' cannot change at runtime: "
+                     "restart to apply them", conf_file_path );
+
+        // Changed settings: the others are rejected, the runtime settings are validated together
+        Json::Value updates( Json::objectValue );
+        std::set<std::string> names;
+        for( const std::string& name: mWatchedSettings.getMemberNames() )
+            names.insert( name );
+        for( const std::string& name: config->settings.getMemberNames() )
+            names.insert( name );
+        for( const std::string& name: names ) {
+            const Json::Value& value = config->settings[name];
+            if ( value == mWatchedSettings[name] )
+                continue;
+            if ( value.isNull() )
+                Warning( "Setting '{}' removed from configuration file '{}': its current value is kept",
+                        name, conf_file_path );
+            else if ( !isRuntimeSetting( name ) )
+                Warning( "Setting '{}' of configuration file '{}' cannot change at runtime: restart to apply it",
+                        name, conf_file_path );
+            else
+                updates[name] = value;
+        }
+
+        try {
+            for( const char* name: { "log_verbosity", "log_file_verbosity" } ) {
+                int verbosity = JVgetOptional( updates, name, Json::intValue, 0 ).asInt();
+                if ( ( verbosity < spdlog::level::trace ) || ( verbosity > spdlog::level::off ) )
+                    Throw( DRM_BadArg, "{} ({}) must be between {} and {}", name, verbosity,
+                            (int)spdlog::level::trace, (int)spdlog::level::off );
+            }
+            updateRuntimeSettings( [&updates]( RuntimeSettings& settings ) {
+                settings.ws_retry_period_long = JVgetOptional( updates, "ws_retry_period_long",
+                        Json::uintValue, settings.ws_retry_period_long ).asUInt();
+                settings.ws_retry_period_short = JVgetOptional( updates, "ws_retry_period_short",
+                        Json::uintValue, settings.ws_retry_period_short ).asUInt();
+                settings.ws_request_timeout = JVgetOptional( updates, "ws_request_timeout",
+                        Json::uintValue, settings.ws_request_timeout ).asUInt();
+                settings.frequency_detection_period = JVgetOptional( updates, "frequency_detection_period",
+                        Json::uintValue, settings.frequency_detection_period ).asUInt();
+                settings.frequency_detection_threshold = JVgetOptional( updates, "frequency_detection_threshold",
+                        Json::uintValue, settings.frequency_detection_threshold ).asDouble();
+            } );
+        } catch( const Exception& e ) {
+            // Nothing is applied, the same changes are checked again on the next reload
+            Warning( "Configuration file '{}' not reloaded: {}", conf_file_path, e.what() );
+            return;
+        }
+
+        if ( updates.isMember( "log_verbosity" ) )
+            setParameter( ParameterKey::log_verbosity, updates["log_verbosity"] );
+        if ( updates.isMember( "log_file_verbosity" ) )
+            setParameter( ParameterKey::log_file_verbosity, updates["log_file_verbosity"] );
+        mWatchedSettings = config->settings;
+
+        if ( !updates.empty() ) {
+            Info( "Configuration file '{}' reloaded: {}", conf_file_path, saveJsonToString( updates ) );
+            Json::Value fields;
+            fields["settings"] = updates;
+            logEvent( "config_reload", fields );
         }
     }
 
+    void startConfigWatch() {
+        if ( mConfigWatchPeriod == 0 )
+            return;
+        mWatchedSettings = mConfig->settings;
+        mConfigWatcher.reset( new ConfigWatcher( mConfig->conf_file_path ) );
+        Debug( "Scheduling the check of configuration file every {} ms", mConfigWatchPeriod );
+        std::chrono::milliseconds period( mConfigWatchPeriod );
+        mConfigWatchTask = mScheduler->schedulePeriodic( TClock::now() + period, period, [ this ]() {
+            try {
+                if ( mConfigWatcher->hasChanged() )
+                    reloadConfiguration();
+            } catch( const std::exception& e ) {
+                Warning( "Failed to reload configuration file: {}", e.what() );
+            }
+        });
+    }
+
+    void stopConfigWatch() {
+        if ( !mConfigWatchTask )
+            return;
+        mScheduler->cancel( mConfigWatchTask );
+        mConfigWatchTask = 0;
+        mConfigWatcher.reset();
+        Debug( "Configuration file check unscheduled" );
+    }
+
     // Get DRM HDK version
     std::string getDrmCtrlVersion() const {
         std::string drmVersion;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().extractDrmVersion( drmVersion ) );
         return drmVersion;
     }
@@ -715,7 +1417,7 @@ protected:
         uint32_t readOnlyMailboxSize, readWriteMailboxSize;
         std::vector<uint32_t> readOnlyMailboxData, readWriteMailboxData;
 
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().extractDrmVersion( drmVersion ) );
         checkDRMCtlrRet( getDrmController().extractDna( dna ) );
         checkDRMCtlrRet( getDrmController().extractVlnvFile( nbOfDetectedIps, vlnvFile ) );
@@ -775,67 +1477,60 @@ protected:
         return json_output;
     }
 
-    Json::Value getMeteringStart() {
-        Json::Value json_request( mHeaderJsonRequest );
+    // Serialize a license request from the metering file extracted from the DRM Controller
+    std::string buildMeteringRequest( const char* request, const std::string& saasChallenge,
+            const std::string& sessionID, const std::vector<std::string>& meteringFile ) const {
+        std::string request_body;
+        mRequestTemplate.build( request_body, request, saasChallenge, sessionID,
+                std::accumulate( meteringFile.begin(), meteringFile.end(), std::string("") ),
+                ( mLicenseType != eLicenseType::NODE_LOCKED ) ? mFrequencyCurr : 0 );
+        return request_body;
+    }
+
+    std::string getMeteringStart() {
+        DRM_TRACE_SCOPE( metering_start );
         uint32_t numberOfDetectedIps;
         std::string saasChallenge;
         std::vector<std::string> meteringFile;
 
         Debug( "Build web request to create new session" );
         mLicenseCounter = 0;
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().initialization( numberOfDetectedIps, saasChallenge, meteringFile ) );
-        json_request["saasChallenge"] = saasChallenge;
-        json_request["meteringFile"]  = std::accumulate( meteringFile.begin(), meteringFile.end(), std::string("") );
-        json_request["request"] = "open";
-        if ( mLicenseType != eLicenseType::NODE_LOCKED )
-            json_request["drm_frequency"] = mFrequencyCurr;
-        json_request["mode"] = (uint8_t)mLicenseType;
-
-        return json_request;
+        return buildMeteringRequest( "open", saasChallenge, "", meteringFile );
     }
 
-    Json::Value getMeteringWait() {
-        Json::Value json_request( mHeaderJsonRequest );
+    std::string getMeteringWait() {
+        DRM_TRACE_SCOPE( metering_wait );
         uint32_t numberOfDetectedIps;
         std::string saasChallenge;
         std::vector<std::string> meteringFile;
 
         Debug( "Build web request to maintain current session" );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().synchronousExtractMeteringFile( numberOfDetectedIps, saasChallenge, meteringFile ) );
-        json_request["saasChallenge"] = saasChallenge;
-        json_request["sessionId"] = meteringFile[0].substr( 0, 16 );
-        checkSessionIDFromDRM( json_request );
-        if ( mLicenseType != eLicenseType::NODE_LOCKED )
-            json_request["drm_frequency"] = mFrequencyCurr;
-        json_request["meteringFile"] = std::accumulate( meteringFile.begin(), meteringFile.end(), std::string("") );
-        json_request["request"] = "running";
-        return json_request;
+        std::string sessionID = meteringFile[0].substr( 0, 16 );
+        checkSessionIDFromDRM( sessionID );
+        return buildMeteringRequest( "running", saasChallenge, sessionID, meteringFile );
     }
 
-    Json::Value getMeteringStop() {
-        Json::Value json_request( mHeaderJsonRequest );
+    std::string getMeteringStop() {
+        DRM_TRACE_SCOPE( metering_stop );
         uint32_t numberOfDetectedIps;
         std::string saasChallenge;
         std::vector<std::string> meteringFile;
 
         Debug( "Build web request to stop current session" );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().endSessionAndExtractMeteringFile( numberOfDetectedIps, saasChallenge, meteringFile ) );
-        json_request["saasChallenge"] = saasChallenge;
-        json_request["sessionId"] = meteringFile[0].substr( 0, 16 );
-        checkSessionIDFromDRM( json_request );
-        if ( mLicenseType != eLicenseType::NODE_LOCKED )
-            json_request["drm_frequency"] = mFrequencyCurr;
-        json_request["meteringFile"]  = std::accumulate( meteringFile.begin(), meteringFile.end(), std::string("") );
-        json_request["request"] = "close";
-        return json_request;
+        std::string sessionID = meteringFile[0].substr( 0, 16 );
+        checkSessionIDFromDRM( sessionID );
+        return buildMeteringRequest( "close", saasChallenge, sessionID, meteringFile );
     }
 
     bool isSessionRunning()const  {
         bool sessionRunning( false );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeRegistersPageRegister() );
         checkDRMCtlrRet( getDrmController().readSessionRunningStatusRegister( sessionRunning ) );
         Debug( "DRM session running state: {}", sessionRunning );
@@ -844,7 +1539,7 @@ protected:
 
     bool isDrmCtrlInNodelock()const  {
         bool isNodelocked( false );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeRegistersPageRegister() );
         checkDRMCtlrRet( getDrmController().readLicenseNodeLockStatusRegister( isNodelocked ) );
         Debug( "DRM Controller node-locked status: {}", isNodelocked );
@@ -853,7 +1548,7 @@ protected:
 
     bool isDrmCtrlInMetering()const  {
         bool isMetering( false );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeRegistersPageRegister() );
         checkDRMCtlrRet( getDrmController().readLicenseMeteringStatusRegister( isMetering ) );
         Debug( "DRM Controller metering status: {}", isMetering );
@@ -862,7 +1557,7 @@ protected:
 
     bool isReadyForNewLicense() const {
         bool ret( false );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeRegistersPageRegister() );
         checkDRMCtlrRet( getDrmController().readLicenseTimerInitLoadedStatusRegister( ret ) );
         Debug( "DRM readiness to receive a new license: {}", !ret );
@@ -871,99 +1566,128 @@ protected:
 
     bool isLicenseActive() const {
         bool isLicenseEmpty( false );
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
         checkDRMCtlrRet( getDrmController().writeRegistersPageRegister() );
         checkDRMCtlrRet( getDrmController().readLicenseTimerCountEmptyStatusRegister( isLicenseEmpty ) );
         return !isLicenseEmpty;
     }
 
-    Json::Value getLicense( const Json::Value& request_json, const uint32_t& timeout,
+    // A 5xx-class error counts as a failure, other errors do not reflect the Web Service health
+    void recordNonRetryableError( const Exception& e ) {
+        if ( e.getErrCode() == DRM_WSError )
+            mCircuitBreaker.recordFailure();
+        else
+            mCircuitBreaker.recordNeutral();
+    }
+
+    Json::Value getLicense( const std::string& request_body, const uint32_t& timeout,
             const uint32_t& short_retry_period = 0, const uint32_t& long_retry_period = 0 ) {
         TClock::time_point deadline = TClock::now() + std::chrono::seconds( timeout );
-        return getLicense( request_json, deadline, short_retry_period, long_retry_period );
+        return getLicense( request_body, deadline, short_retry_period, long_retry_period );
     }
 
-    Json::Value getLicense( const Json::Value& request_json, const TClock::time_point& deadline,
-            const uint32_t& short_retry_period = 0, const uint32_t& long_retry_period = 0 ) {
+    // Wait before the next attempt of a failed Web Service request, return false if no more attempt is allowed
+    bool waitBeforeRetry( const std::string& request_name, const Exception& e, const uint32_t& attempt,
+            const TClock::time_point& deadline, const uint32_t& short_retry_period,
+            const uint32_t& long_retry_period ) {
+        if ( TClock::now() > deadline ) {
+            // Reached timeout
+            Throw( DRM_WSError, "Timeout on {} request after {} attempts", request_name, attempt );
+        }
+        if ( short_retry_period == 0 ) {
+            // No retry
+            return false;
+        }
+        TClock::duration wait_duration;
+        if ( !mRetryPolicy->getNextDelay( attempt, deadline - TClock::now(),
+                std::chrono::seconds( short_retry_period ), std::chrono::seconds( long_retry_period ),
+                wait_duration ) ) {
+            Throw( DRM_WSError, "{} request failed after {} attempts: retry budget is exhausted. Last error: {}",
+                    request_name, attempt, e.what() );
+        }
+        // Honor the delay requested by the server
+        TClock::duration retry_after = std::chrono::seconds( getDrmWSClient().getRetryAfter() );
+        if ( retry_after > wait_duration ) {
+            Debug( "Web Service requested to retry after {} seconds", getDrmWSClient().getRetryAfter() );
+            wait_duration = retry_after;
+        }
+        if ( TClock::now() + wait_duration > deadline )
+            wait_duration = std::max( deadline - TClock::now(), TClock::duration::zero() );
+        Warning( "Attempt #{} of {} request failed with message: {}. New attempt planned in {} seconds",
+                attempt, request_name, e.what(), std::chrono::duration_cast<std::chrono::seconds>( wait_duration ).count() );
+        // Wait a bit before retrying
+        sleepOrExit( wait_duration );
+        return true;
+    }
+
+    // Wait until the circuit breaker lets a request through; fail fast if it cannot happen before deadline
+    void waitCircuitBreaker( const std::string& request_name, const TClock::time_point& deadline ) {
+        TClock::time_point retry_time;
+        while ( !mCircuitBreaker.allowRequest( retry_time ) ) {
+            if ( retry_time > deadline )
+                Throw( DRM_WSError, "{} request aborted: License Web Service is considered down by the circuit breaker",
+                        request_name );
+            Debug( "Circuit breaker is open: waiting {} ms before the next {} request",
+                    std::chrono::duration_cast<std::chrono::milliseconds>( retry_time - TClock::now() ).count(),
+                    request_name );
+            sleepOrExit( retry_time );
+        }
+    }
 
-        TClock::duration long_duration = std::chrono::seconds( long_retry_period );
-        TClock::duration short_duration = std::chrono::seconds( short_retry_period );
+    Json::Value getLicense( const std::string& request_body, const TClock::time_point& deadline,
+            const uint32_t& short_retry_period = 0, const uint32_t& long_retry_period = 0,
+            const bool& full_response = false ) {
+        DRM_TRACE_SCOPE( get_license );
 
         // Get valid OAUth2 token
         uint32_t attempt = 0;
-        TClock::duration wait_duration;
         while ( 1 ) {
+            waitCircuitBreaker( "Authentication", deadline );
             try {
                 getDrmWSClient().requestOAuth2token( deadline );
+                mCircuitBreaker.recordSuccess();
                 break;
             } catch ( const Exception& e ) {
                 if ( e.getErrCode() != DRM_WSMayRetry ) {
+                    recordNonRetryableError( e );
                     throw;
                 }
                 // It is retryable
+                mCircuitBreaker.recordFailure();
                 attempt ++;
-                if ( TClock::now() > deadline ) {
-                    // Reached timeout
-                    Throw( DRM_WSError, "Timeout on Authentication request after {} attempts", attempt );
-                }
-                if ( short_retry_period == 0 ) {
-                    // No retry
+                if ( !waitBeforeRetry( "Authentication", e, attempt, deadline,
+                        short_retry_period, long_retry_period ) )
                     throw;
-                }
-                // Perform retry
-                if ( long_retry_period == 0 ) {
-                     wait_duration = short_duration;
-                } else {
-                    if ( ( deadline - TClock::now() ) < long_duration )
-                        wait_duration = short_duration;
-                    else
-                        wait_duration = long_duration;
-                }
-                Warning( "Attempt #{} to obtain a new OAuth2 token failed with message: {}. New attempt planned in {} seconds",
-                        attempt, e.what(), wait_duration.count()/1000000000 );
-                // Wait a bit before retrying
-                sleepOrExit( wait_duration );
             }
         }
 
         // Get new license
         attempt = 0;
         while ( 1 ) {
+            waitCircuitBreaker( "License", deadline );
             try {
-                return getDrmWSClient().requestLicense( request_json, deadline );
+                Json::Value license_json = getDrmWSClient().requestLicense( request_body, mRequestTemplate.getDna(),
+                        deadline, full_response );
+                mCircuitBreaker.recordSuccess();
+                return license_json;
             } catch ( const Exception& e ) {
                 if ( e.getErrCode() != DRM_WSMayRetry ) {
+                    recordNonRetryableError( e );
                     throw;
                 }
                 // It is retryable
+                mCircuitBreaker.recordFailure();
                 attempt ++;
-                if ( TClock::now() > deadline ) {
-                    // Reached timeout
-                    Throw( DRM_WSError, "Timeout on License request after {} attempts", attempt );
-                }
-                if ( short_retry_period == 0 ) {
-                    // No retry
+                if ( !waitBeforeRetry( "License", e, attempt, deadline,
+                        short_retry_period, long_retry_period ) )
                     throw;
-                }
-                // Perform retry
-                if ( long_retry_period == 0 ) {
-                     wait_duration = short_duration;
-                } else {
-                    if ( ( deadline - TClock::now() ) < long_duration )
-                        wait_duration = short_duration;
-                    else
-                        wait_duration = long_duration;
-                }
-                Warning( "Attempt #{} to obtain a new License failed with message: {}. New attempt planned in {} seconds",
-                        attempt, e.what(), wait_duration.count()/1000000000 );
-                // Wait a bit before retrying
-                sleepOrExit( wait_duration );
             }
         }
     }
 
     void setLicense( const Json::Value& license_json ) {
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        DRM_TRACE_SCOPE( set_license );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
 
         Debug( "Installing next license on DRM controller" );
 
@@ -978,7 +1702,7 @@ protected:
             /// Get session ID received from web service
             if ( mSessionID.empty() ) {
                 /// Save new Session ID
-                mSessionID = JVgetRequired( metering_node, "sessionId", Json::stringValue ).asString();
+                setSessionID( JVgetRequired( metering_node, "sessionId", Json::stringValue ).asString() );
                 Debug( "Saving session ID: {}", mSessionID );
             } else {
                 /// Verify Session ID
@@ -1001,6 +1725,11 @@ protected:
             Throw( DRM_WSRespError, "Malformed response from License Web Service: {}", e.what() );
         }
 
+        // Time left on the current license, only read for the event log
+        uint32_t timeLeftAtInstall = 0;
+        if ( mEventLog && ( mLicenseType != eLicenseType::NODE_LOCKED ) && ( mLicenseCounter > 0 ) )
+            timeLeftAtInstall = getCurrentLicenseTimeLeft();
+
         // Activate
         bool activationDone = false;
         uint8_t activationErrorCode;
@@ -1009,6 +1738,7 @@ protected:
             Throw( DRM_CtlrError, "Failed to activate license on DRM controller, activationErr: 0x{:x}",
                   activationErrorCode );
         }
+        mMetrics.licensesInstalled.inc();
 
         // Load license timer
         if ( mLicenseType != eLicenseType::NODE_LOCKED ) {
@@ -1021,8 +1751,20 @@ protected:
                       licenseTimerEnabled );
             }
 
+            ++mLicenseCounter;
             Debug( "Set license #{} of session ID {} for a duration of {} seconds",
-                    ++mLicenseCounter, mSessionID, mLicenseDuration );
+                    mLicenseCounter, mSessionID, mLicenseDuration );
+        }
+        if ( mEventLog ) {
+            Json::Value fields;
+            if ( mLicenseType == eLicenseType::NODE_LOCKED ) {
+                fields["node_locked"] = true;
+            } else {
+                fields["license_number"] = mLicenseCounter;
+                fields["license_duration_s"] = mLicenseDuration;
+                fields["time_left_s"] = timeLeftAtInstall;
+            }
+            mEventLog->write( "license_installed", fields );
         }
 
         // Check DRM Controller has switched to the right license mode
@@ -1069,7 +1811,7 @@ protected:
             return;
         }
         // Build request for node-locked license
-        Json::Value request_json = getMeteringStart();
+        Json::Value request_json = parseJsonString( getMeteringStart() );
         Debug( "License request JSON:\n{}", request_json.toStyledString() );
 
         // Save license request to file
@@ -1092,17 +1834,19 @@ protected:
             /// No license has been found locally, request one to License WS:
             /// - Clear Session IS
             Debug( "Clearing session ID: {}", mSessionID );
-            mSessionID = std::string("");
+            setSessionID( "" );
             /// - Create WS access
-            mWsClient.reset( new DrmWSClient( mConfFilePath, mCredFilePath ) );
+            createWSClient();
             /// - Read request file
             try {
                 Json::Value request_json = parseJsonFile( mNodeLockRequestFilePath );
                 Debug( "Parsed Node-locked License Request file: {}", request_json .toStyledString() );
                 /// - Send request to web service and receive the new license
+                RuntimeSettings settings = getRuntimeSettings();
                 TClock::time_point deadline =
-                        TClock::now() + std::chrono::seconds( mWSRequestTimeout );
-                license_json = getLicense( request_json, deadline, mWSRetryPeriodShort );
+                        TClock::now() + std::chrono::seconds( settings.ws_request_timeout );
+                license_json = getLicense( saveJsonToString( request_json ), deadline,
+                        settings.ws_retry_period_short, 0, true );
                 /// - Save the license to file
                 saveJsonToFile( mNodeLockLicenseFilePath, license_json );
                 Debug( "Requested and saved new node-locked license file: {}", mNodeLockLicenseFilePath );
@@ -1118,12 +1862,14 @@ protected:
     void detectDrmFrequency() {
         TClock::time_point timeStart, timeEnd;
         uint64_t counterStart, counterEnd;
-        TClock::duration wait_duration = std::chrono::milliseconds( mFrequencyDetectionPeriod );
+        RuntimeSettings settings = getRuntimeSettings();
+        TClock::duration wait_duration = std::chrono::milliseconds( settings.frequency_detection_period );
         int max_attempts = 3;
 
-        std::lock_guard<std::recursive_mutex> lock( mDrmControllerMutex );
+        DRM_TRACE_SCOPE( detect_frequency );
+        TControllerLock lock( mDrmControllerMutex, __func__ );
 
-        Debug( "Detecting DRM frequency for {} ms", mFrequencyDetectionPeriod );
+        Debug( "Detecting DRM frequency for {} ms", settings.frequency_detection_period );
 
         while ( max_attempts > 0 ) {
 
@@ -1163,38 +1909,68 @@ protected:
         double seconds = double( timeSpan.count() ) * TClock::period::num / TClock::period::den;
         auto ticks = (uint32_t)(counterStart - counterEnd);
         auto measuredFrequency = (int32_t)(std::ceil((double)ticks / seconds / 1000000));
+        DRM_TRACE_ARGS( detect_frequency_result, measuredFrequency, ticks );
         Debug( "Duration = {} s   /   ticks = {}   =>   estimated frequency = {} MHz", seconds, ticks, measuredFrequency );
 
         // Compuate precision error compared to config file
         double precisionError = 100.0 * abs( measuredFrequency - mFrequencyCurr ) / mFrequencyCurr ; // At that point mFrequencyCurr = mFrequencyInit
-        if ( precisionError >= mFrequencyDetectionThreshold ) {
+        if ( mEventLog ) {
+            Json::Value fields;
+            fields["measured_mhz"] = measuredFrequency;
+            fields["config_mhz"] = mFrequencyInit;
+            fields["error_percent"] = precisionError;
+            fields["threshold_percent"] = settings.frequency_detection_threshold;
+            fields["ticks"] = ticks;
+            fields["duration_s"] = seconds;
+            mEventLog->write( "frequency_detection", fields );
+        }
+        if ( precisionError >= settings.frequency_detection_threshold ) {
             mFrequencyCurr = measuredFrequency;
             Throw( DRM_BadFrequency,
                     "Estimated DRM frequency ({} MHz) differs from the value ({} MHz) defined in the configuration file '{}' by more than {}%: From now on the considered frequency is {} MHz",
-                    mFrequencyCurr, mFrequencyInit, mConfFilePath, mFrequencyDetectionThreshold, mFrequencyCurr);
+                    mFrequencyCurr, mFrequencyInit, mConfig->conf_file_path, settings.frequency_detection_threshold, mFrequencyCurr);
         } else {
             Debug( "Estimated DRM frequency = {} MHz, config frequency = {} MHz: gap = {}%",
                     measuredFrequency, mFrequencyInit, precisionError );
         }
     }
 
-    template< class Clock, class Duration >
-    void sleepOrExit(
-            const std::chrono::time_point<Clock, Duration> &timeout_time) {
-        std::unique_lock<std::mutex> lock( mThreadKeepAliveMtx );
-        bool isExitRequested = mThreadKeepAliveCondVar.wait_until( lock, timeout_time,
-                [ this ]{ return mThreadStopRequest; } );
+    // Wait until time, unless a stop is requested. License renewals, retries and backoffs wait for a
+    // wakeup from the timer wheel of the scheduler: its worker only tracks the deadlines while the
+    // waiting thread runs the blocking requests. The slots of a group use the group scheduler.
+    // The deadline is still enforced locally: a scheduler worker stalled by another task only
+    // delays the wakeup by SCHEDULER_WAKEUP_SLACK.
+    void sleepOrExit( const TClock::time_point& time ) {
+        Scheduler* scheduler = mGroup ? mGroup->scheduler.get() : mScheduler.get();
+        std::shared_ptr<bool> is_woken = std::make_shared<bool>( false );
+        Scheduler::TTaskId task = 0;
+        if ( scheduler )
+            task = scheduler->schedule( time, [ this, is_woken ]() {
+                std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
+                *is_woken = true;
+                mThreadKeepAliveCondVar.notify_all();
+            });
+        bool isExitRequested;
+        {
+            std::unique_lock<std::mutex> lock( mThreadKeepAliveMtx );
+            auto is_done = [ this, &is_woken ]{ return *is_woken || mThreadStopRequest; };
+            if ( scheduler ) {
+                if ( !mThreadKeepAliveCondVar.wait_until( lock, time + SCHEDULER_WAKEUP_SLACK, is_done ) )
+                    Debug2( "Scheduler wakeup is late: resuming on the local deadline" );
+            } else {
+                mThreadKeepAliveCondVar.wait_until( lock, time, is_done );
+            }
+            isExitRequested = mThreadStopRequest;
+        }
+        // Remove the wakeup if a stop is requested, or wait for its end
+        if ( task )
+            scheduler->cancel( task );
         if ( isExitRequested )
             Throw( DRM_Exit, "Exit requested" );
     }
 
-    template< class Rep, class Period >
-    void sleepOrExit( const std::chrono::duration<Rep, Period> &rel_time ) {
-        std::unique_lock<std::mutex> lock( mThreadKeepAliveMtx );
-        bool isExitRequested = mThreadKeepAliveCondVar.wait_for( lock, rel_time,
-                [ this ]{ return mThreadStopRequest; } );
-        if ( isExitRequested )
-            Throw( DRM_Exit, "Exit requested" );
+    void sleepOrExit( const TClock::duration& rel_time ) {
+        sleepOrExit( TClock::now() + rel_time );
     }
 
     bool isStopRequested() {
@@ -1207,94 +1983,366 @@ protected:
         return (uint32_t)std::ceil( (double)counterCurr / mFrequencyCurr / 1000000 );
     }
 
+    // Time at which the current license expires, from the license timer counter and the measured frequency
+    TClock::time_point getCurrentLicenseExpiration() {
+        TClock::time_point before = TClock::now();
+        uint64_t counterCurr = getTimerCounterValue();
+        // The counter is sampled somewhere between the 2 clock reads
+        TClock::time_point anchor = before + ( TClock::now() - before ) / 2;
+        uint64_t frequency = (uint64_t)mFrequencyCurr;  // in MHz: 1 count every 1/frequency us
+        return anchor + std::chrono::microseconds( counterCurr / frequency )
+                + std::chrono::nanoseconds( ( counterCurr % frequency ) * 1000 / frequency );
+    }
+
+    // Run one step of the license continuity: return the time of the next step
+    TClock::time_point licenseContinuityStep() {
+
+        mMetrics.pollIterations.inc();
+
+        // Check DRM licensing queue
+        bool is_ready = isReadyForNewLicense();
+        if ( mLicenseExpirationWakeup != TClock::time_point() ) {
+            // Woken up by the expiration of the current license
+            TClock::duration delay = TClock::now() - mLicenseExpirationWakeup;
+            if ( is_ready )
+                mMetrics.wakeupDelay.record( (uint64_t)std::max( (int64_t)0, (int64_t)
+                        std::chrono::duration_cast<std::chrono::microseconds>( delay ).count() ) );
+            else
+                mMetrics.earlyWakeups.inc();
+            mLicenseExpirationWakeup = TClock::time_point();
+        }
+        if ( !is_ready ) {
+            // DRM licensing queue is full, wait until current license expires. The expiration
+            // computed after an early wakeup may already be past: do not poll the controller in a loop.
+            mLicenseExpirationWakeup = std::max( getCurrentLicenseExpiration(),
+                    TClock::now() + LICENSE_CHECK_MIN_DELAY );
+            Debug( "Sleeping for {} ms before checking DRM Controller readiness for a new license",
+                    std::chrono::duration_cast<std::chrono::milliseconds>(
+                    mLicenseExpirationWakeup - TClock::now() ).count() );
+            return mLicenseExpirationWakeup;
+        }
+        if ( isStopRequested() )
+            Throw( DRM_Exit, "Exit requested" );
+
+        Debug( "Requesting a new license now" );
+        TClock::time_point renewal_start = TClock::now();
+
+        std::string request_body = getMeteringWait();
+        Json::Value license_json;
+
+        /// Retry Web Service request loop
+        TClock::time_point polling_deadline = TClock::now()
+                + std::chrono::seconds( mLicenseDuration );
+
+        /// Attempt to get the next license
+        RuntimeSettings settings = getRuntimeSettings();
+        license_json = getLicense( request_body, polling_deadline,
+                settings.ws_retry_period_short, settings.ws_retry_period_long );
+
+        /// New license has been received: now send it to the DRM Controller
+        mMetrics.timeLeftAtRenewal.record( getCurrentLicenseTimeLeft() );
+        setLicense( license_json );
+        mMetrics.renewalLatency.record( (uint64_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                TClock::now() - renewal_start ).count() );
+        return TClock::now();
+    }
+
+    void reportContinuityError( const std::exception& e ) {
+        const Exception* drm_e = dynamic_cast<const Exception*>( &e );
+        if ( drm_e && ( drm_e->getErrCode() == DRM_Exit ) )
+            return;
+        Error( e.what() );
+        reportAsyncError( std::string( e.what() ) );
+    }
+
+    // Slot of a group: run the continuity steps which are due from a worker of the group, then queue
+    // the next job at the time of the next step. A worker is only held while the slot runs a step.
+    void runContinuityJob( const bool& detect_frequency ) {
+        TClock::time_point next_step;
+        try {
+            if ( isStopRequested() )
+                Throw( DRM_Exit, "Exit requested" );
+            if ( detect_frequency )
+                detectDrmFrequency();
+            do {
+                next_step = licenseContinuityStep();
+            } while ( next_step <= TClock::now() );
+        } catch( const std::exception& e ) {
+            reportContinuityError( e );
+            std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
+            mContinuityActive = false;
+            mThreadKeepAliveCondVar.notify_all();
+            return;
+        }
+        std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
+        if ( mThreadStopRequest ) {
+            mContinuityActive = false;
+            mThreadKeepAliveCondVar.notify_all();
+            return;
+        }
+        std::shared_ptr<GroupResources> group = mGroup;
+        mContinuityTask = group->scheduler->schedule( next_step, [ this, group ]() {
+            group->workers->submit( [ this ]() { runContinuityJob( false ); } );
+        });
+    }
+
     void startLicenseContinuityThread() {
 
-        if ( mThreadKeepAlive.valid() ) {
+        if ( mThreadKeepAlive.valid() || mContinuityPooled ) {
             Warning( "Thread already started" );
             return;
         }
+        mLicenseExpirationWakeup = TClock::time_point();
+
+        if ( mGroup ) {
+            Debug( "Starting license continuity on the workers of the group" );
+            mContinuityPooled = true;
+            {
+                std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
+                mContinuityActive = true;
+            }
+            mGroup->workers->submit( [ this ]() { runContinuityJob( true ); } );
+            return;
+        }
 
         Debug( "Starting background thread which maintains licensing" );
 
-        mThreadKeepAlive = std::async( std::launch::async, [ this ]() {
+        mThreadKeepAlive = startThread( mThreadSettings, mThreadSettings.name, [ this ]() {
             try {
                 /// Detecting DRM controller frequency
                 detectDrmFrequency();
 
                 /// Starting license request loop
                 while( 1 ) {
-
-                    // Check DRM licensing queue
-                    if ( !isReadyForNewLicense() ) {
-                        // DRM licensing queue is full, wait until current license expires
-                        uint32_t licenseTimeLeft = getCurrentLicenseTimeLeft();
-                        TClock::duration wait_duration = std::chrono::seconds( licenseTimeLeft + 1 );
-                        Debug( "Sleeping for {} seconds before checking DRM Controller readiness for a new license",
-                                licenseTimeLeft );
-                        sleepOrExit( wait_duration );
-
-                    } else {
-                        if ( isStopRequested() )
-                            return;
-
-                        Debug( "Requesting a new license now" );
-
-                        Json::Value request_json = getMeteringWait();
-                        Json::Value license_json;
-
-                        /// Retry Web Service request loop
-                        TClock::time_point polling_deadline = TClock::now()
-                                + std::chrono::seconds( mLicenseDuration );
-
-                        /// Attempt to get the next license
-                        license_json = getLicense( request_json, polling_deadline,
-                                mWSRetryPeriodShort, mWSRetryPeriodLong );
-
-                        /// New license has been received: now send it to the DRM Controller
-                        setLicense( license_json );
-                    }
-                }
-            } catch( const Exception& e ) {
-                if ( e.getErrCode() != DRM_Exit ) {
-                    Error( e.what() );
-                    f_asynch_error( std::string( e.what() ) );
+                    TClock::time_point next_step = licenseContinuityStep();
+                    if ( next_step > TClock::now() )
+                        sleepOrExit( next_step );
                 }
             } catch( const std::exception& e ) {
-                Error( e.what() );
-                f_asynch_error( std::string( e.what() ) );
+                reportContinuityError( e );
             }
         });
     }
 
-    void stopThread() {
-        if ( !mThreadKeepAlive.valid() ) {
-            Debug( "Background thread was not running" );
-            return;
-        }
+    void stopContinuityJobs() {
+        Scheduler::TTaskId task;
         {
             std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
-            Debug( "Stop flag of thread is set" );
+            Debug( "Stop flag of continuity jobs is set" );
             mThreadStopRequest = true;
+            task = mContinuityTask;
+            mContinuityTask = 0;
         }
         mThreadKeepAliveCondVar.notify_all();
-        mThreadKeepAlive.get();
-        Debug( "Background thread stopped" );
-        {
+        // A task removed before it ran will never queue the next job; otherwise the job sees the stop flag
+        if ( task && mGroup->scheduler->cancel( task ) ) {
             std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
-            Debug( "Stop flag of thread is reset" );
+            mContinuityActive = false;
+        }
+        {
+            std::unique_lock<std::mutex> lock( mThreadKeepAliveMtx );
+            mThreadKeepAliveCondVar.wait( lock, [ this ]{ return !mContinuityActive; } );
             mThreadStopRequest = false;
         }
+        mContinuityPooled = false;
+        Debug( "Continuity jobs stopped" );
     }
 
-    void startSession() {
+    void stopThread() {
+        if ( mContinuityPooled ) {
+            stopContinuityJobs();
+            return;
+        }
+        if ( !mThreadKeepAlive.valid() ) {
+            Debug( "Background thread was not running" );
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
+            Debug( "Stop flag of thread is set" );
+            mThreadStopRequest = true;
+        }
+        mThreadKeepAliveCondVar.notify_all();
+        mThreadKeepAlive.get();
+        Debug( "Background thread stopped" );
+        {
+            std::lock_guard<std::mutex> lock( mThreadKeepAliveMtx );
+            Debug( "Stop flag of thread is reset" );
+            mThreadStopRequest = false;
+        }
+    }
+
+    bool sleepOrExitJournal( const TClock::duration& rel_time ) {
+        std::unique_lock<std::mutex> lock( mThreadJournalMtx );
+        return mThreadJournalCondVar.wait_for( lock, rel_time, [ this ]{
+                return mThreadJournalStopRequest || mThreadJournalFinalAttempt; } );
+    }
+
+    // The entry will never be accepted: keep it aside
+    void rejectJournalEntry( const std::string& entry_path, const Exception& e ) {
+        Error( "Failed to upload metering journal entry {}: {}", entry_path, e.what() );
+        mMeteringJournal->reject( entry_path );
+        reportAsyncError( std::string( e.what() ) );
+    }
+
+    // Upload a journal entry with its own Web Service client: return false if exit is requested
+    bool uploadJournalEntry( DrmWSClient& ws_client, const std::string& entry_path,
+            const uint32_t& request_timeout, const uint32_t& retry_period ) {
+        Json::Value request_json;
+        try {
+            request_json = mMeteringJournal->read( entry_path );
+        } catch( const Exception& e ) {
+            if ( e.getErrCode() != DRM_BadFormat )
+                throw;
+            rejectJournalEntry( entry_path, e );
+            return true;
+        }
+        std::string session_id = request_json.get( "sessionId", "" ).asString();
+        TClock::time_point deadline = TClock::now() + std::chrono::seconds( request_timeout );
+        uint32_t attempt = 0;
+        while ( 1 ) {
+            bool license_requested = false;
+            try {
+                ws_client.requestOAuth2token( deadline );
+                license_requested = true;
+                Json::Value license_json = ws_client.requestLicense( request_json, deadline );
+                if ( license_json["metering"]["sessionId"].asString() != session_id )
+                    Warning( "Session ID mismatch: received '{}' from WS but expect '{}'",
+                            license_json["metering"]["sessionId"].asString(), session_id );
+                break;
+            } catch ( const Exception& e ) {
+                // Only a 4xx answer of the License Web Service to valid credentials is definitive
+                long resp_code = ws_client.getResponseCode();
+                if ( license_requested && ( e.getErrCode() == DRM_WSReqError )
+                        && ( resp_code != 401 ) && ( resp_code != 403 ) ) {
+                    rejectJournalEntry( entry_path, e );
+                    return true;
+                }
+                if ( e.getErrCode() != DRM_WSMayRetry )
+                    throw;
+                {
+                    std::lock_guard<std::mutex> lock( mThreadJournalMtx );
+                    if ( mThreadJournalFinalAttempt )
+                        throw;
+                }
+                attempt ++;
+                TClock::duration delay = std::chrono::seconds( std::max( (long)retry_period,
+                        ws_client.getRetryAfter() ) );
+                if ( TClock::now() + delay >= deadline )
+                    throw;
+                Warning( "Attempt #{} to upload journaled metering of session {} failed with message: {}. "
+                         "New attempt planned in {} seconds", attempt, session_id, e.what(),
+                         std::chrono::duration_cast<std::chrono::seconds>( delay ).count() );
+                if ( sleepOrExitJournal( delay ) )
+                    return false;
+            }
+        }
+        mMeteringJournal->remove( entry_path );
+        Info( "Journaled metering data of session ID {} uploaded", session_id );
+        return true;
+    }
+
+    void uploadJournal( const uint32_t& request_timeout, const uint32_t& retry_period ) {
+        std::unique_ptr<DrmWSClient> ws_client;
+        for( const std::string& entry_path: mMeteringJournal->list() ) {
+            {
+                std::lock_guard<std::mutex> lock( mThreadJournalMtx );
+                if ( mThreadJournalStopRequest )
+                    return;
+            }
+            int fd = mMeteringJournal->lock( entry_path );
+            if ( fd < 0 ) {
+                Debug( "Metering journal entry {} is being uploaded by another instance", entry_path );
+                continue;
+            }
+            try {
+                if ( !ws_client ) {
+                    ws_client.reset( new DrmWSClient( *mConfig ) );
+                    ws_client->setStatistics( mOAuth2Statistics, mLicenseStatistics );
+                    ws_client->setEventLog( mEventLog );
+                }
+                bool done = uploadJournalEntry( *ws_client, entry_path, request_timeout, retry_period );
+                mMeteringJournal->unlock( fd );
+                if ( !done )
+                    return;
+            } catch( const Exception& e ) {
+                // Authentication, network and server errors may be transient: keep the entry for a later replay
+                mMeteringJournal->unlock( fd );
+                Warning( "Failed to upload metering journal entry {}, it will be replayed later: {}",
+                        entry_path, e.what() );
+            }
+        }
+    }
+
+    void startJournalUploadThread() {
+        std::lock_guard<std::mutex> lock( mThreadJournalMtx );
+        mThreadJournalUploadRequest = true;
+        if ( mThreadJournalRunning )
+            return;     // The running thread will list the journal again
+        if ( mThreadJournal.valid() )
+            mThreadJournal.get();
+        mThreadJournalRunning = true;
+        mThreadJournalStopRequest = false;
+        Debug( "Starting background thread which uploads the metering journal" );
+
+        // The settings may change while the thread runs
+        RuntimeSettings settings = getRuntimeSettings();
+        uint32_t request_timeout = settings.ws_request_timeout;
+        uint32_t retry_period = settings.ws_retry_period_short;
+        mThreadJournal = startThread( mThreadSettings, "drm_journal", [ this, request_timeout, retry_period ]() {
+            while ( 1 ) {
+                {
+                    std::lock_guard<std::mutex> lock( mThreadJournalMtx );
+                    if ( !mThreadJournalUploadRequest || mThreadJournalStopRequest ) {
+                        mThreadJournalRunning = false;
+                        return;
+                    }
+                    mThreadJournalUploadRequest = false;
+                }
+                try {
+                    uploadJournal( request_timeout, retry_period );
+                } catch( const std::exception& e ) {
+                    Error( "Failed to upload metering journal: {}", e.what() );
+                }
+            }
+        });
+    }
+
+    // Make a last upload attempt without retrying, then stop the thread if it is still running at timeout
+    void stopJournalUploadThread( const TClock::duration& timeout ) {
+        if ( !mMeteringJournal )
+            return;
+        {
+            std::lock_guard<std::mutex> lock( mThreadJournalMtx );
+            mThreadJournalFinalAttempt = true;
+        }
+        mThreadJournalCondVar.notify_all();
+        // The thread may have already stopped on a failed upload
+        startJournalUploadThread();
+        if ( mThreadJournal.wait_for( timeout ) != std::future_status::ready ) {
+            Warning( "Metering journal upload did not complete in time: it will be replayed later" );
+            {
+                std::lock_guard<std::mutex> lock( mThreadJournalMtx );
+                mThreadJournalStopRequest = true;
+            }
+            mThreadJournalCondVar.notify_all();
+        }
+        mThreadJournal.get();
+        Debug( "Metering journal upload thread stopped" );
+    }
+
+    void startSession() {
         Info( "Starting a new metering session..." );
 
         // Build start request message for new license
-        Json::Value request_json = getMeteringStart();
+        std::string request_body = getMeteringStart();
 
         // Send request and receive new license
-        Json::Value license_json = getLicense( request_json, mWSRequestTimeout, mWSRetryPeriodShort );
+        RuntimeSettings settings = getRuntimeSettings();
+        Json::Value license_json = getLicense( request_body, settings.ws_request_timeout,
+                settings.ws_retry_period_short );
         setLicense( license_json );
+        logEvent( "session_start" );
 
         startLicenseContinuityThread();
     }
@@ -1305,14 +2353,17 @@ protected:
         if ( isReadyForNewLicense() ) {
 
             // Create JSON license request
-            Json::Value request_json = getMeteringWait();
+            std::string request_body = getMeteringWait();
 
             // Send license request to web service
-            Json::Value license_json = getLicense( request_json, mWSRequestTimeout, mWSRetryPeriodShort );
+            RuntimeSettings settings = getRuntimeSettings();
+            Json::Value license_json = getLicense( request_body, settings.ws_request_timeout,
+                    settings.ws_retry_period_short );
 
             // Install license on DRM controller
             setLicense( license_json );
         }
+        logEvent( "session_resume" );
         startLicenseContinuityThread();
     }
 
@@ -1323,59 +2374,90 @@ protected:
         stopThread();
 
         // Get and send metering data to web service
-        Json::Value request_json = getMeteringStop();
+        std::string request_body = getMeteringStop();
 
-        // Send last metering information
-        Json::Value license_json = getLicense( request_json, mWSRequestTimeout, mWSRetryPeriodShort );
-        checkSessionIDFromWS( license_json );
-        Info( "Session ID {} stopped and last metering data uploaded", mSessionID );
+        if ( mMeteringJournal ) {
+            // Upload last metering information in background
+            mMeteringJournal->append( request_body, mSessionID );
+            startJournalUploadThread();
+            Info( "Session ID {} stopped and last metering data journaled", mSessionID );
+        } else {
+            // Send last metering information
+            RuntimeSettings settings = getRuntimeSettings();
+            Json::Value license_json = getLicense( request_body, settings.ws_request_timeout,
+                    settings.ws_retry_period_short );
+            checkSessionIDFromWS( license_json );
+            Info( "Session ID {} stopped and last metering data uploaded", mSessionID );
+        }
+        if ( mEventLog ) {
+            Json::Value fields;
+            fields["journaled"] = ( mMeteringJournal != nullptr );
+            fields["license_count"] = mLicenseCounter;
+            mEventLog->write( "session_stop", fields );
+        }
 
         /// Clear Session IS
         Debug( "Clearing session ID: {}", mSessionID );
-        mSessionID = std::string("");
+        setSessionID( "" );
     }
 
     void pauseSession() {
         Info( "Pausing DRM session..." );
         stopThread();
         mSecurityStop = false;
+        logEvent( "session_pause" );
     }
 
-    ParameterKey findParameterKey( const std::string& key_string ) const {
-        for ( auto const& it : mParameterKeyMap ) {
-            if ( key_string == it.second ) {
-                return it.first;
-            }
-        }
-        Throw( DRM_BadArg, "Cannot find parameter: {}", key_string );
+    static ParameterKey findParameterKey( const std::string& key_string ) {
+        const std::unordered_map<std::string, ParameterKey>& ids = getParameterKeyIds();
+        auto it = ids.find( key_string );
+        if ( it == ids.end() )
+            Throw( DRM_BadArg, "Cannot find parameter: {}", key_string );
+        return it->second;
     }
 
-    std::string findParameterString( const ParameterKey key_id ) const {
-        std::map<ParameterKey, std::string>::const_iterator it;
-        it = mParameterKeyMap.find( key_id );
-        if ( it == mParameterKeyMap.end() )
+    static const std::string& findParameterString( const ParameterKey key_id ) {
+        if ( ( key_id < 0 ) || ( key_id > ParameterKeyCount ) )
             Throw( DRM_BadArg, "Cannot find parameter with ID: {}", key_id );
-        return it->second;
+        return getParameterKeyNames()[key_id];
     }
 
     Json::Value list_parameter_key() const {
-        Json::Value node;
-        for( int i=0; i<ParameterKey::ParameterKeyCount; i++ ) {
-            ParameterKey e = static_cast<ParameterKey>( i );
-            std::string keyStr = findParameterString( e );
-            node.append( keyStr );
-        }
+        Json::Value node( Json::arrayValue );
+        for( int i=0; i<ParameterKey::ParameterKeyCount; i++ )
+            node.append( getParameterKeyNames()[i] );
         return node;
     }
 
+    // Parameters not read by dump_all: write-only, printing, costly or consuming parameters
+    static bool isDumpable( const ParameterKey& key ) {
+        static const std::set<ParameterKey> excluded = {
+            ParameterKey::dump_all, ParameterKey::log_service_path, ParameterKey::log_service_type,
+            ParameterKey::log_service_rotating_size, ParameterKey::log_service_rotating_num,
+            ParameterKey::log_service_verbosity, ParameterKey::log_service_format,
+            ParameterKey::page_ctrlreg, ParameterKey::page_vlnvfile, ParameterKey::page_licfile,
+            ParameterKey::page_tracefile, ParameterKey::page_meteringfile, ParameterKey::page_mailbox,
+            ParameterKey::hw_report, ParameterKey::log_service_create, ParameterKey::trigger_async_callback,
+            ParameterKey::bad_product_id, ParameterKey::bad_oauth2_token, ParameterKey::log_message,
+            ParameterKey::hw_snapshot, ParameterKey::metered_data_samples
+        };
+        return excluded.count( key ) == 0;
+    }
+
+    // Parameters read from the Web Service client, which only exists once a floating/metered license is used
+    static bool needsWSClient( const ParameterKey& key ) {
+        return ( key == ParameterKey::token_string ) || ( key == ParameterKey::token_validity )
+                || ( key == ParameterKey::token_time_left );
+    }
+
     Json::Value dump_parameter_key() const {
         Json::Value node;
-        for( int i=0; i<ParameterKey::dump_all; i++ ) {
+        for( int i=0; i<ParameterKey::ParameterKeyCount; i++ ) {
             ParameterKey e = static_cast<ParameterKey>( i );
-            std::string keyStr = findParameterString( e );
-            node[ keyStr ] = Json::nullValue;
+            if ( !isDumpable( e ) || ( needsWSClient( e ) && !mWsClient ) )
+                continue;
+            node[ getParameterKeyNames()[i] ] = getParameter( e );
         }
-        get( node );
         return node;
     }
 
@@ -1385,8 +2467,9 @@ public:
           const std::string& cred_file_path,
           ReadRegisterCallback f_user_read_register,
           WriteRegisterCallback f_user_write_register,
-          AsynchErrorCallback f_user_asynch_error )
-        : Impl( conf_file_path, cred_file_path )
+          AsynchErrorCallback f_user_asynch_error,
+          const std::shared_ptr<GroupResources>& group = nullptr )
+        : Impl( conf_file_path, cred_file_path, group ? group->config : nullptr )
     {
         if ( !f_user_read_register )
             Throw( DRM_BadArg, "Read register callback function must not be NULL" );
@@ -1397,7 +2480,24 @@ public:
         f_read_register = f_user_read_register;
         f_write_register = f_user_write_register;
         f_asynch_error = f_user_asynch_error;
+        mGroup = group;
         initDrmInterface();
+        getNumActivator( mNumActivators );
+        mScheduler = Scheduler::getShared( mThreadSettings );
+        if ( mAsyncErrorQueueSize ) {
+            // The slots of a group deliver their errors from the workers of the group
+            AsyncErrorDispatcher::TExecutor executor;
+            if ( mGroup ) {
+                std::shared_ptr<GroupResources> group = mGroup;
+                executor = [ group ]( std::function<void()> task ) { group->workers->submit( std::move( task ) ); };
+            }
+            mAsyncErrorDispatcher.reset( new AsyncErrorDispatcher( f_asynch_error, mAsyncErrorQueueSize,
+                    mThreadSettings, mMetrics.asyncErrorsCoalesced, mMetrics.asyncErrorsDropped, executor ) );
+        }
+        startConfigWatch();
+        startMetricsThread();
+        startActivatorsStatusThread();
+        startSamplingThread();
     }
 
     ~Impl() {
@@ -1407,8 +2507,15 @@ public:
                 stopSession();
             }
         }
+        stopConfigWatch();
         stopThread();
+        stopJournalUploadThread( std::chrono::seconds( getRuntimeSettings().ws_request_timeout ) );
+        stopMetricsThread();
+        stopActivatorsStatusThread();
+        stopSamplingThread();
+        mAsyncErrorDispatcher.reset();
         unlockDrmToInstance();
+        logLockTopHolders();
         uninitLog();
     }
 
@@ -1417,6 +2524,7 @@ public:
     Impl( Impl&& ) = delete;
 
     void activate( const bool& resume_session_request = false ) {
+        DRM_TRACE_SCOPE( activate );
         TRY
             Debug( "Calling 'activate' with 'resume_session_request'={}", resume_session_request );
 
@@ -1450,6 +2558,7 @@ public:
     }
 
     void deactivate( const bool& pause_session_request = false ) {
+        DRM_TRACE_SCOPE( deactivate );
         TRY
             Debug( "Calling 'deactivate' with 'pause_session_request'={}", pause_session_request );
 
@@ -1467,324 +2576,379 @@ public:
         CATCH_AND_THROW
     }
 
-    void get( Json::Value& json_value ) const {
+    void setAsyncErrorExecutor( DrmManager::AsynchErrorExecutor executor ) {
         TRY
-            for( const std::string& key_str : json_value.getMemberNames() ) {
-                const ParameterKey key_id = findParameterKey( key_str );
-                Debug2( "Getting parameter '{}'", key_str );
-                switch( key_id ) {
-                    case ParameterKey::log_verbosity: {
-                        int logVerbosity = static_cast<int>( sLogConsoleVerbosity );
-                        json_value[key_str] = logVerbosity;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                logVerbosity );
-                        break;
-                    }
-                    case ParameterKey::log_format: {
-                        json_value[key_str] = sLogConsoleFormat;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                sLogConsoleFormat );
-                        break;
-                    }
-                    case ParameterKey::log_file_verbosity: {
-                        int logVerbosity = static_cast<int>( sLogFileVerbosity );
-                        json_value[key_str] = logVerbosity;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                logVerbosity );
-                        break;
-                    }
-                    case ParameterKey::log_file_format: {
-                        json_value[key_str] = sLogFileFormat;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                sLogFileFormat );
-                        break;
-                    }
-                    case ParameterKey::log_file_path: {
-                        json_value[key_str] = sLogFilePath;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                sLogFilePath );
-                        break;
-                    }
-                    case ParameterKey::log_file_type: {
-                        json_value[key_str] = (int)sLogFileType;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               (int)sLogFileType );
-                        break;
-                    }
-                    case ParameterKey::log_file_rotating_num: {
-                        json_value[key_str] = (int)sLogFileRotatingNum;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               sLogFileRotatingNum );
-                        break;
-                    }
-                    case ParameterKey::log_file_rotating_size: {
-                        json_value[key_str] = (int)sLogFileRotatingSize;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               sLogFileRotatingSize );
-                        break;
-                    }
-                    case ParameterKey::log_service_verbosity: {
-                        int logVerbosity = static_cast<int>( sLogServiceVerbosity );
-                        json_value[key_str] = logVerbosity;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               logVerbosity );
-                        break;
-                    }
-                    case ParameterKey::log_service_format: {
-                        json_value[key_str] = sLogServiceFormat;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               sLogServiceFormat );
-                        break;
-                    }
-                    case ParameterKey::log_service_path: {
-                        json_value[key_str] = sLogServicePath;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               sLogServicePath );
-                        break;
-                    }
-                    case ParameterKey::log_service_type: {
-                        json_value[key_str] = (int)sLogServiceType;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               (int)sLogServiceType );
-                        break;
-                    }
-                    case ParameterKey::log_service_rotating_num: {
-                        json_value[key_str] = (int)sLogServiceRotatingNum;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               sLogServiceRotatingNum );
-                        break;
-                    }
-                    case ParameterKey::log_service_rotating_size: {
-                        json_value[key_str] = (int)sLogServiceRotatingSize;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               sLogServiceRotatingSize );
-                        break;
-                    }
-                    case ParameterKey::license_type: {
-                        auto it = LicenseTypeStringMap.find( mLicenseType );
-                        if ( it == LicenseTypeStringMap.end() )
-                            Unreachable( "License_type '", (uint32_t)mLicenseType,
-                                    "' is missing in LicenseTypeStringMap" ); //LCOV_EXCL_LINE
-                        std::string license_type_str = it->second;
-                        json_value[key_str] = license_type_str;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                license_type_str );
-                        break;
-                    }
-                    case ParameterKey::license_duration: {
-                        json_value[key_str] = mLicenseDuration;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                mLicenseDuration );
-                        break;
-                    }
-                    case ParameterKey::num_activators: {
-                        uint32_t nbActivators = 0;
-                        getNumActivator( nbActivators );
-                        json_value[key_str] = nbActivators;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                nbActivators );
-                        break;
-                    }
-                    case ParameterKey::session_id: {
-                        json_value[key_str] = mSessionID;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                                mSessionID );
-                        break;
-                    }
-                    case ParameterKey::session_status: {
-                        bool status = isSessionRunning();
-                        json_value[key_str] = status;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               status );
-                        break;
-                    }
-                    case ParameterKey::license_status: {
-                        bool status = isLicenseActive();
-                        json_value[key_str] = status;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               status );
-                        break;
-                    }
-                    case ParameterKey::metered_data: {
+            if ( !mAsyncErrorDispatcher )
+                Throw( DRM_BadUsage, "Set async_error_queue_size to dispatch asynchronous errors through an executor" );
+            mAsyncErrorDispatcher->setExecutor( executor );
+        CATCH_AND_THROW
+    }
+
+    // Value of a single parameter: typed getters call it directly
+    Json::Value getParameter( const ParameterKey key_id ) const {
+        const std::string& key_str = findParameterString( key_id );
+        Json::Value value;
+        Debug2( "Getting parameter '{}'", key_str );
+        switch( key_id ) {
+            case ParameterKey::log_verbosity: {
+                int logVerbosity = static_cast<int>( sLogConsoleVerbosity );
+                value = logVerbosity;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        logVerbosity );
+                break;
+            }
+            case ParameterKey::log_format: {
+                value = sLogConsoleFormat;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        sLogConsoleFormat );
+                break;
+            }
+            case ParameterKey::log_file_verbosity: {
+                int logVerbosity = static_cast<int>( sLogFileVerbosity );
+                value = logVerbosity;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        logVerbosity );
+                break;
+            }
+            case ParameterKey::log_file_format: {
+                value = sLogFileFormat;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        sLogFileFormat );
+                break;
+            }
+            case ParameterKey::log_file_path: {
+                value = sLogFilePath;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        sLogFilePath );
+                break;
+            }
+            case ParameterKey::log_file_type: {
+                value = (int)sLogFileType;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       (int)sLogFileType );
+                break;
+            }
+            case ParameterKey::log_file_rotating_num: {
+                value = (int)sLogFileRotatingNum;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       sLogFileRotatingNum );
+                break;
+            }
+            case ParameterKey::log_file_rotating_size: {
+                value = (int)sLogFileRotatingSize;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       sLogFileRotatingSize );
+                break;
+            }
+            case ParameterKey::log_service_verbosity: {
+                int logVerbosity = static_cast<int>( sLogServiceVerbosity );
+                value = logVerbosity;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       logVerbosity );
+                break;
+            }
+            case ParameterKey::log_service_format: {
+                value = sLogServiceFormat;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       sLogServiceFormat );
+                break;
+            }
+            case ParameterKey::log_service_path: {
+                value = sLogServicePath;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       sLogServicePath );
+                break;
+            }
+            case ParameterKey::log_service_type: {
+                value = (int)sLogServiceType;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       (int)sLogServiceType );
+                break;
+            }
+            case ParameterKey::log_service_rotating_num: {
+                value = (int)sLogServiceRotatingNum;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       sLogServiceRotatingNum );
+                break;
+            }
+            case ParameterKey::log_service_rotating_size: {
+                value = (int)sLogServiceRotatingSize;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       sLogServiceRotatingSize );
+                break;
+            }
+            case ParameterKey::license_type: {
+                auto it = LicenseTypeStringMap.find( mLicenseType );
+                if ( it == LicenseTypeStringMap.end() )
+                    Unreachable( "License_type '", (uint32_t)mLicenseType,
+                            "' is missing in LicenseTypeStringMap" ); //LCOV_EXCL_LINE
+                std::string license_type_str = it->second;
+                value = license_type_str;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        license_type_str );
+                break;
+            }
+            case ParameterKey::license_duration: {
+                value = mLicenseDuration;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        mLicenseDuration );
+                break;
+            }
+            case ParameterKey::num_activators: {
+                uint32_t nbActivators = 0;
+                getNumActivator( nbActivators );
+                value = nbActivators;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        nbActivators );
+                break;
+            }
+            case ParameterKey::activators_status: {
+                value = getActivatorsStatus();
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.toStyledString() );
+                break;
+            }
+            case ParameterKey::metered_data_samples: {
+                value = popMeteredDataSamples();
+                Debug( "Get value of parameter '{}' (ID={}): {} samples", key_str, key_id,
+                       value["samples"].size() );
+                break;
+            }
+            case ParameterKey::session_id: {
+                value = mSessionID;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                        mSessionID );
+                break;
+            }
+            case ParameterKey::session_status: {
+                bool status = isSessionRunning();
+                value = status;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       status );
+                break;
+            }
+            case ParameterKey::license_status: {
+                bool status = isLicenseActive();
+                value = status;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       status );
+                break;
+            }
+            case ParameterKey::metered_data: {
 #if ((JSONCPP_VERSION_MAJOR ) >= 1 and ((JSONCPP_VERSION_MINOR) > 7 or ((JSONCPP_VERSION_MINOR) == 7 and JSONCPP_VERSION_PATCH >= 5)))
-                        uint64_t metered_data = 0;
+                uint64_t metered_data = 0;
 #else
-                        // No "int64_t" support with JsonCpp < 1.7.5
-                        unsigned long long metered_data = 0;
+                // No "int64_t" support with JsonCpp < 1.7.5
+                unsigned long long metered_data = 0;
 #endif
-                        metered_data = getMeteringData();
-                        json_value[key_str] = metered_data;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               metered_data );
-                        break;
-                    }
-                    case ParameterKey::nodelocked_request_file: {
-                        if ( mLicenseType != eLicenseType::NODE_LOCKED ) {
-                            json_value[key_str] = std::string("Not applicable");
-                            Warning( "Parameter only available with Node-Locked licensing" );
-                        } else {
-                            json_value[key_str] = mNodeLockRequestFilePath;
-                            Debug( "Get value of parameter '{}' (ID={}): Node-locked license request file is saved in {}",
-                                    key_str, key_id, mNodeLockRequestFilePath );
-                        }
-                        break;
-                    }
-                    case ParameterKey::page_ctrlreg:
-                    case ParameterKey::page_vlnvfile:
-                    case ParameterKey::page_licfile:
-                    case ParameterKey::page_tracefile:
-                    case ParameterKey::page_meteringfile:
-                    case ParameterKey::page_mailbox: {
-                        std::string str = getDrmPage( key_id - ParameterKey::page_ctrlreg );
-                        json_value[key_str] = str;
-                        Debug( "Get value of parameter '{}' (ID={})", key_str, key_id );
-                        Info( str );
-                        break;
-                    }
-                    case ParameterKey::hw_report: {
-                        std::string str = getDrmReport();
-                        json_value[key_str] = str;
-                        Debug( "Get value of parameter '{}' (ID={})", key_str, key_id );
-                        Info( "Print HW report:\n{}", str );
-                        break;
-                    }
-                    case ParameterKey::drm_frequency: {
-                        json_value[key_str] = mFrequencyCurr;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mFrequencyCurr );
-                        break;
-                    }
-                    case ParameterKey::drm_license_type: {
-                        eLicenseType lic_type;
-                        bool is_nodelock = isDrmCtrlInNodelock();
-                        bool is_metering = isDrmCtrlInMetering();
-                        if ( is_metering )
-                            lic_type = eLicenseType::METERED;
-                        else if ( is_nodelock )
-                            lic_type = eLicenseType::NODE_LOCKED;
-                        else
-                            lic_type = eLicenseType::NONE;
-                        auto it = LicenseTypeStringMap.find( lic_type );
-                        std::string status = it->second;
-                        json_value[key_str] = status;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               status );
-                        break;
-                    }
-                    case ParameterKey::frequency_detection_threshold: {
-                        json_value[key_str] = mFrequencyDetectionThreshold;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mFrequencyDetectionThreshold );
-                        break;
-                    }
-                    case ParameterKey::frequency_detection_period: {
-                        json_value[key_str] = mFrequencyDetectionPeriod;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mFrequencyDetectionPeriod );
-                        break;
-                    }
-                    case ParameterKey::product_info: {
-                        json_value[key_str] = mHeaderJsonRequest["product"];
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mHeaderJsonRequest["product"].toStyledString() );
-                        break;
-                    }
-                    case ParameterKey::token_string: {
-                        std::string token_string = getDrmWSClient().getTokenString();
-                        json_value[key_str] = token_string;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               token_string );
-                        break;
-                    }
-                    case ParameterKey::token_validity: {
-                        uint32_t validity = getDrmWSClient().getTokenValidity();
-                        json_value[key_str] = validity ;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               validity  );
-                        break;
-                    }
-                    case ParameterKey::token_time_left: {
-                        uint32_t time_left = getDrmWSClient().getTokenTimeLeft();
-                        json_value[key_str] = time_left;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               time_left );
-                        break;
-                    }
-                    case ParameterKey::mailbox_size: {
-                        uint32_t mbSize = getMailboxSize() - (uint32_t)eMailboxOffset::MB_USER;
-                        json_value[key_str] = mbSize;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mbSize );
-                        break;
-                    }
-                    case ParameterKey::mailbox_data: {
-                        uint32_t mbSize = getMailboxSize() - (uint32_t)eMailboxOffset::MB_USER;
-                        std::vector<uint32_t> data_array = readMailbox( eMailboxOffset::MB_USER, mbSize );
-                        for( const auto& val: data_array )
-                            json_value[key_str].append( val );
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               json_value[key_str].toStyledString() );
-                        break;
-                    }
-                    case ParameterKey::ws_retry_period_long: {
-                        json_value[key_str] = mWSRetryPeriodLong;
-                        Debug( "Get value of parameter '", key_str,
-                                "' (ID=", key_id, "): ", mWSRetryPeriodLong );
-                        break;
-                    }
-                    case ParameterKey::ws_retry_period_short: {
-                        json_value[key_str] = mWSRetryPeriodShort;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mWSRetryPeriodShort );
-                        break;
-                    }
-                    case ParameterKey::ws_request_timeout: {
-                        json_value[key_str] = mWSRequestTimeout ;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               mWSRequestTimeout  );
-                        break;
-                    }
-                    case ParameterKey::log_message_level: {
-                        int msgLevel = static_cast<int>( mDebugMessageLevel );
-                        json_value[key_str] = msgLevel;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               msgLevel );
-                        break;
-                    }
-                    case ParameterKey::custom_field: {
-                        uint32_t customField = readMailbox( eMailboxOffset::MB_CUSTOM_FIELD );
-                        json_value[key_str] = customField;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               customField );
-                        break;
-                    }
-                    case ParameterKey ::list_all: {
-                        Json::Value list = list_parameter_key();
-                        json_value[key_str] = list;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               list.toStyledString() );
-                        break;
-                    }
-                    case ParameterKey::dump_all: {
-                        Json::Value list = dump_parameter_key();
-                        json_value[key_str] = list;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               list.toStyledString() );
-                        break;
-                    }
-                    case ParameterKey::ParameterKeyCount: {
-                        uint32_t count = static_cast<int>( ParameterKeyCount );
-                        json_value[key_str] = count;
-                        Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
-                               count );
-                        break;
-                    }
-                    default: {
-                        Throw( DRM_BadArg, "Parameter '{}' cannot be read", key_str );
-                        break;
-                    }
+                metered_data = getMeteringCounter();
+                value = metered_data;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       metered_data );
+                break;
+            }
+            case ParameterKey::nodelocked_request_file: {
+                if ( mLicenseType != eLicenseType::NODE_LOCKED ) {
+                    value = std::string("Not applicable");
+                    Warning( "Parameter only available with Node-Locked licensing" );
+                } else {
+                    value = mNodeLockRequestFilePath;
+                    Debug( "Get value of parameter '{}' (ID={}): Node-locked license request file is saved in {}",
+                            key_str, key_id, mNodeLockRequestFilePath );
                 }
+                break;
+            }
+            case ParameterKey::page_ctrlreg:
+            case ParameterKey::page_vlnvfile:
+            case ParameterKey::page_licfile:
+            case ParameterKey::page_tracefile:
+            case ParameterKey::page_meteringfile:
+            case ParameterKey::page_mailbox: {
+                std::string str = getDrmPage( key_id - ParameterKey::page_ctrlreg );
+                value = str;
+                Debug( "Get value of parameter '{}' (ID={})", key_str, key_id );
+                Info( str );
+                break;
+            }
+            case ParameterKey::hw_report: {
+                std::string str = getDrmReport();
+                value = str;
+                Debug( "Get value of parameter '{}' (ID={})", key_str, key_id );
+                Info( "Print HW report:\n{}", str );
+                break;
             }
+            case ParameterKey::hw_snapshot: {
+                value = getHwSnapshot().toJson();
+                Debug( "Get value of parameter '{}' (ID={})", key_str, key_id );
+                break;
+            }
+            case ParameterKey::drm_frequency: {
+                value = mFrequencyCurr;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       mFrequencyCurr );
+                break;
+            }
+            case ParameterKey::drm_license_type: {
+                eLicenseType lic_type;
+                bool is_nodelock = isDrmCtrlInNodelock();
+                bool is_metering = isDrmCtrlInMetering();
+                if ( is_metering )
+                    lic_type = eLicenseType::METERED;
+                else if ( is_nodelock )
+                    lic_type = eLicenseType::NODE_LOCKED;
+                else
+                    lic_type = eLicenseType::NONE;
+                auto it = LicenseTypeStringMap.find( lic_type );
+                std::string status = it->second;
+                value = status;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       status );
+                break;
+            }
+            case ParameterKey::frequency_detection_threshold: {
+                value = getRuntimeSettings().frequency_detection_threshold;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.asString() );
+                break;
+            }
+            case ParameterKey::frequency_detection_period: {
+                value = getRuntimeSettings().frequency_detection_period;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.asString() );
+                break;
+            }
+            case ParameterKey::product_info: {
+                value = mHeaderJsonRequest["product"];
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       mHeaderJsonRequest["product"].toStyledString() );
+                break;
+            }
+            case ParameterKey::token_string: {
+                std::string token_string = getDrmWSClient().getTokenString();
+                value = token_string;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       token_string );
+                break;
+            }
+            case ParameterKey::token_validity: {
+                uint32_t validity = getDrmWSClient().getTokenValidity();
+                value = validity ;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       validity  );
+                break;
+            }
+            case ParameterKey::token_time_left: {
+                uint32_t time_left = getDrmWSClient().getTokenTimeLeft();
+                value = time_left;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       time_left );
+                break;
+            }
+            case ParameterKey::mailbox_size: {
+                uint32_t mbSize = getMailboxSize() - (uint32_t)eMailboxOffset::MB_USER;
+                value = mbSize;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       mbSize );
+                break;
+            }
+            case ParameterKey::mailbox_data: {
+                uint32_t mbSize = getMailboxSize() - (uint32_t)eMailboxOffset::MB_USER;
+                std::vector<uint32_t> data_array = readMailbox( eMailboxOffset::MB_USER, mbSize );
+                for( const auto& val: data_array )
+                    value.append( val );
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.toStyledString() );
+                break;
+            }
+            case ParameterKey::ws_retry_period_long: {
+                value = getRuntimeSettings().ws_retry_period_long;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.asString() );
+                break;
+            }
+            case ParameterKey::ws_retry_period_short: {
+                value = getRuntimeSettings().ws_retry_period_short;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.asString() );
+                break;
+            }
+            case ParameterKey::ws_request_timeout: {
+                value = getRuntimeSettings().ws_request_timeout;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.asString() );
+                break;
+            }
+            case ParameterKey::thread_settings: {
+                value = mThreadSettings.toJson();
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.toStyledString() );
+                break;
+            }
+            case ParameterKey::log_message_level: {
+                int msgLevel = static_cast<int>( mDebugMessageLevel );
+                value = msgLevel;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       msgLevel );
+                break;
+            }
+            case ParameterKey::custom_field: {
+                uint32_t customField = readMailbox( eMailboxOffset::MB_CUSTOM_FIELD );
+                value = customField;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       customField );
+                break;
+            }
+            case ParameterKey::ws_oauth2_statistics: {
+                value = mOAuth2Statistics->toJson();
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.toStyledString() );
+                break;
+            }
+            case ParameterKey::ws_license_statistics: {
+                value = mLicenseStatistics->toJson();
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.toStyledString() );
+                break;
+            }
+            case ParameterKey::metrics: {
+                value = getMetrics();
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       value.toStyledString() );
+                break;
+            }
+            case ParameterKey ::list_all: {
+                Json::Value list = list_parameter_key();
+                value = list;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       list.toStyledString() );
+                break;
+            }
+            case ParameterKey::dump_all: {
+                Json::Value list = dump_parameter_key();
+                value = list;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       list.toStyledString() );
+                break;
+            }
+            case ParameterKey::ParameterKeyCount: {
+                uint32_t count = static_cast<int>( ParameterKeyCount );
+                value = count;
+                Debug( "Get value of parameter '{}' (ID={}): {}", key_str, key_id,
+                       count );
+                break;
+            }
+            default: {
+                Throw( DRM_BadArg, "Parameter '{}' cannot be read", key_str );
+                break;
+            }
+        }
+        return value;
+    }
+
+    void get( Json::Value& json_value ) const {
+        TRY
+            for( const std::string& key_str : json_value.getMemberNames() )
+                json_value[key_str] = getParameter( findParameterKey( key_str ) );
         CATCH_AND_THROW
     }
 
@@ -1801,221 +2965,230 @@ public:
         Unreachable( "Default template for get function" ); //LCOV_EXCL_LINE
     }
 
-    void set( const Json::Value& json_value ) {
-        TRY
-            for( Json::ValueConstIterator it = json_value.begin() ; it != json_value.end() ; it++ ) {
-                std::string key_str = it.key().asString();
-                const ParameterKey key_id = findParameterKey( key_str );
-                switch( key_id ) {
-                    case ParameterKey::log_verbosity: {
-                        int verbosityInt = (*it).asInt();
-                        sLogConsoleVerbosity = static_cast<spdlog::level::level_enum>( verbosityInt );
-                        sLogger->sinks()[0]->set_level( sLogConsoleVerbosity );
-                        if ( sLogConsoleVerbosity < sLogger->level() )
-                            sLogger->set_level( sLogConsoleVerbosity );
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                verbosityInt );
-                        break;
-                    }
-                    case ParameterKey::log_format: {
-                        std::string logFormat = (*it).asString();
-                        sLogger->sinks()[0]->set_pattern( logFormat );
-                        sLogConsoleFormat = logFormat;
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                sLogConsoleFormat );
-                        break;
-                    }
-                    case ParameterKey::log_file_verbosity: {
-                        int verbosityInt = (*it).asInt();
-                        sLogFileVerbosity = static_cast<spdlog::level::level_enum>( verbosityInt );
-                        sLogger->sinks()[1]->set_level( sLogFileVerbosity );
-                        if ( sLogFileVerbosity < sLogger->level() )
-                            sLogger->set_level( sLogFileVerbosity );
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               verbosityInt);
-                        break;
-                    }
-                    case ParameterKey::log_file_format: {
-                        sLogFileFormat = (*it).asString();
-                        if ( sLogger->sinks().size() > 1 ) {
-                            sLogger->sinks()[1]->set_pattern( sLogFileFormat );
-                        }
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               sLogFileFormat );
-                        break;
-                    }
-                    case ParameterKey::log_service_verbosity: {
-                        int verbosityInt = (*it).asInt();
-                        sLogServiceVerbosity = static_cast<spdlog::level::level_enum>( verbosityInt );
-                        if ( sLogger->sinks().size() == 3 ) {
-                            sLogger->sinks()[2]->set_level( sLogServiceVerbosity );
-                            if ( sLogServiceVerbosity < sLogger->level() )
-                                sLogger->set_level( sLogServiceVerbosity );
-                        }
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, verbosityInt );
-                        break;
-                    }
-                    case ParameterKey::log_service_format: {
-                        sLogServiceFormat = (*it).asString();
-                        if ( sLogger->sinks().size() == 3 ) {
-                            sLogger->sinks()[2]->set_pattern( sLogServiceFormat );
-                        }
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               sLogServiceFormat );
-                        break;
-                    }
-                    case ParameterKey::log_service_path: {
-                        if ( sLogger->sinks().size() < 3 ) {
-                            sLogServicePath = (*it).asString();
-                            Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                   sLogServicePath );
-                        } else {
-                            Warning( "A service logging is already in use: cannot change its settings" );
-                        }
-                        break;
-                    }
-                    case ParameterKey::log_service_type: {
-                        if ( sLogger->sinks().size() < 3 ) {
-                            int logType = (*it).asInt();
-                            sLogServiceType = static_cast<eLogFileType>( logType  );
-                            Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                   (int)sLogServiceType );
-                        } else {
-                            Warning( "A service logging is already in use" );
-                        }
-                        break;
-                    }
-                    case ParameterKey::log_service_rotating_size: {
-                        if ( sLogger->sinks().size() < 3 ) {
-                            sLogServiceRotatingSize = (*it).asUInt();
-                            Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                   sLogServiceRotatingSize );
-                        } else {
-                            Warning( "A service logging is already in use" );
-                        }
-                        break;
-                    }
-                    case ParameterKey::log_service_rotating_num: {
-                        if ( sLogger->sinks().size() < 3 ) {
-                            sLogServiceRotatingNum = (*it).asUInt();
-                            Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                   sLogServiceRotatingNum );
-                        } else {
-                            Warning( "A service logging is already in use" );
-                        }
-                        break;
-                    }
-                    case ParameterKey::log_service_create: {
-                        if ( sLogger->sinks().size() < 3 ) {
-                            std::string dummy = (*it).asString();
-                            createFileLog( sLogServicePath, sLogServiceType, sLogServiceVerbosity,
-                                    sLogServiceFormat, sLogServiceRotatingSize, sLogServiceRotatingNum );
-                            Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                                   dummy );
-                        } else {
-                            Warning( "A service logging is already in use" );
-                        }
-                        break;
-                    }
-
-                    case ParameterKey::frequency_detection_threshold: {
-                        mFrequencyDetectionThreshold = (*it).asDouble();
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               mFrequencyDetectionThreshold );
-                        break;
-                    }
-                    case ParameterKey::frequency_detection_period: {
-                        mFrequencyDetectionPeriod = (*it).asUInt();
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               mFrequencyDetectionPeriod );
-                        break;
-                    }
-                    case ParameterKey::custom_field: {
-                        uint32_t customField = (*it).asUInt();
-                        writeMailbox( eMailboxOffset::MB_CUSTOM_FIELD, customField );
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               customField );
-                        break;
-                    }
-                    case ParameterKey::mailbox_data: {
-                        if ( !(*it).isArray() )
-                            Throw( DRM_BadArg, "Value must be an array of integers" );
-                        std::vector<uint32_t> data_array;
-                        for( Json::ValueConstIterator itr = (*it).begin(); itr != (*it).end(); itr++ )
-                            data_array.push_back( (*itr).asUInt() );
-                        writeMailbox( eMailboxOffset::MB_USER, data_array );
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               (*it).toStyledString());
-                        break;
-                    }
-                    case ParameterKey::ws_retry_period_long: {
-                        uint32_t retry_period = (*it).asUInt();
-                        if ( retry_period <= mWSRetryPeriodShort )
-                            Throw( DRM_BadArg,
-                                    "ws_retry_period_long ({}) must be greater than ws_retry_period_short ({})",
-                                    retry_period, mWSRetryPeriodShort );
-                        mWSRetryPeriodLong = retry_period;
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               mWSRetryPeriodLong );
-                        break;
-                    }
-                    case ParameterKey::ws_retry_period_short: {
-                        uint32_t retry_period = (*it).asUInt();
-                        if ( mWSRetryPeriodLong <= retry_period )
-                            Throw( DRM_BadArg,
-                                    "ws_retry_period_long ({}) must be greater than ws_retry_period_short ({})",
-                                    mWSRetryPeriodLong, retry_period );
-                        mWSRetryPeriodShort = retry_period;
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               mWSRetryPeriodShort );
-                        break;
-                    }
-                    case ParameterKey::ws_request_timeout: {
-                        mWSRequestTimeout  = (*it).asUInt();
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               mWSRequestTimeout  );
-                        if ( mWSRequestTimeout == 0 )
-                            Throw( DRM_BadArg, "ws_request_timeout must not be 0");
-                        break;
-                    }
-                    case ParameterKey::trigger_async_callback: {
-                        std::string custom_msg = (*it).asString();
-                        Exception e( DRM_Debug, custom_msg );
-                        f_asynch_error( e.what() );
-                        Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
-                               custom_msg );
-                        break;
-                    }
-                    case ParameterKey::bad_product_id: {
-                        Debug( "Set parameter '{}' (ID={}) to random value", key_str, key_id );
-                        mHeaderJsonRequest["product"]["name"] = "BAD_NAME_JUST_FOR_TEST";
-                        break;
-                    }
-                    case ParameterKey::bad_oauth2_token: {
-                        Debug( "Set parameter '{}' (ID={}) to random value", key_str, key_id );
-                        getDrmWSClient().setOAuth2token( "BAD_TOKEN" );
-                        break;
-                    }
-                    case ParameterKey::log_message_level: {
-                        int message_level = (*it).asInt();
-                        if ( ( message_level < spdlog::level::trace)
-                          || ( message_level > spdlog::level::off) )
-                            Throw( DRM_BadArg, "log_message_level ({}) is out of range [{:d}:{:d}]",
-                                    message_level, (int)spdlog::level::trace, (int)spdlog::level::off );
-                        mDebugMessageLevel = static_cast<spdlog::level::level_enum>( message_level );
-                        Debug( "Set parameter '{}' (ID={}) to value {}", key_str, key_id,
-                                message_level );
-                        break;
-                    }
-                    case ParameterKey::log_message: {
-                        std::string custom_msg = (*it).asString();
-                        SPDLOG_LOGGER_CALL( sLogger, (spdlog::level::level_enum)mDebugMessageLevel, custom_msg);
-                        break;
-                    }
-                    default:
-                        Throw( DRM_BadArg, "Parameter '{}' cannot be overwritten", key_str );
+    // Set a single parameter: typed setters call it directly
+    void setParameter( const ParameterKey key_id, const Json::Value& value ) {
+        const std::string& key_str = findParameterString( key_id );
+        switch( key_id ) {
+            case ParameterKey::log_verbosity: {
+                int verbosityInt = value.asInt();
+                sLogConsoleVerbosity = static_cast<spdlog::level::level_enum>( verbosityInt );
+                sLogger->sinks()[0]->set_level( sLogConsoleVerbosity );
+                if ( sLogConsoleVerbosity < sLogger->level() )
+                    sLogger->set_level( sLogConsoleVerbosity );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                        verbosityInt );
+                break;
+            }
+            case ParameterKey::log_format: {
+                std::string logFormat = value.asString();
+                sLogger->sinks()[0]->set_pattern( logFormat );
+                sLogConsoleFormat = logFormat;
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                        sLogConsoleFormat );
+                break;
+            }
+            case ParameterKey::log_file_verbosity: {
+                int verbosityInt = value.asInt();
+                sLogFileVerbosity = static_cast<spdlog::level::level_enum>( verbosityInt );
+                sLogger->sinks()[1]->set_level( sLogFileVerbosity );
+                if ( sLogFileVerbosity < sLogger->level() )
+                    sLogger->set_level( sLogFileVerbosity );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       verbosityInt);
+                break;
+            }
+            case ParameterKey::log_file_format: {
+                sLogFileFormat = value.asString();
+                if ( sLogger->sinks().size() > 1 ) {
+                    sLogger->sinks()[1]->set_pattern( sLogFileFormat );
                 }
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       sLogFileFormat );
+                break;
+            }
+            case ParameterKey::log_service_verbosity: {
+                int verbosityInt = value.asInt();
+                sLogServiceVerbosity = static_cast<spdlog::level::level_enum>( verbosityInt );
+                if ( sLogger->sinks().size() == 3 ) {
+                    sLogger->sinks()[2]->set_level( sLogServiceVerbosity );
+                    if ( sLogServiceVerbosity < sLogger->level() )
+                        sLogger->set_level( sLogServiceVerbosity );
+                }
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, verbosityInt );
+                break;
+            }
+            case ParameterKey::log_service_format: {
+                sLogServiceFormat = value.asString();
+                if ( sLogger->sinks().size() == 3 ) {
+                    sLogger->sinks()[2]->set_pattern( sLogServiceFormat );
+                }
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       sLogServiceFormat );
+                break;
             }
+            case ParameterKey::log_service_path: {
+                if ( sLogger->sinks().size() < 3 ) {
+                    sLogServicePath = value.asString();
+                    Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                           sLogServicePath );
+                } else {
+                    Warning( "A service logging is already in use: cannot change its settings" );
+                }
+                break;
+            }
+            case ParameterKey::log_service_type: {
+                if ( sLogger->sinks().size() < 3 ) {
+                    int logType = value.asInt();
+                    sLogServiceType = static_cast<eLogFileType>( logType  );
+                    Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                           (int)sLogServiceType );
+                } else {
+                    Warning( "A service logging is already in use" );
+                }
+                break;
+            }
+            case ParameterKey::log_service_rotating_size: {
+                if ( sLogger->sinks().size() < 3 ) {
+                    sLogServiceRotatingSize = value.asUInt();
+                    Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                           sLogServiceRotatingSize );
+                } else {
+                    Warning( "A service logging is already in use" );
+                }
+                break;
+            }
+            case ParameterKey::log_service_rotating_num: {
+                if ( sLogger->sinks().size() < 3 ) {
+                    sLogServiceRotatingNum = value.asUInt();
+                    Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                           sLogServiceRotatingNum );
+                } else {
+                    Warning( "A service logging is already in use" );
+                }
+                break;
+            }
+            case ParameterKey::log_service_create: {
+                if ( sLogger->sinks().size() < 3 ) {
+                    std::string dummy = value.asString();
+                    createFileLog( sLogServicePath, sLogServiceType, sLogServiceVerbosity,
+                            sLogServiceFormat, sLogServiceRotatingSize, sLogServiceRotatingNum );
+                    Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                           dummy );
+                } else {
+                    Warning( "A service logging is already in use" );
+                }
+                break;
+            }
+
+            case ParameterKey::frequency_detection_threshold: {
+                double threshold = value.asDouble();
+                updateRuntimeSettings( [threshold]( RuntimeSettings& settings ) {
+                    settings.frequency_detection_threshold = threshold;
+                } );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, threshold );
+                break;
+            }
+            case ParameterKey::frequency_detection_period: {
+                uint32_t period = value.asUInt();
+                updateRuntimeSettings( [period]( RuntimeSettings& settings ) {
+                    settings.frequency_detection_period = period;
+                } );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, period );
+                break;
+            }
+            case ParameterKey::custom_field: {
+                uint32_t customField = value.asUInt();
+                writeMailbox( eMailboxOffset::MB_CUSTOM_FIELD, customField );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       customField );
+                break;
+            }
+            case ParameterKey::mailbox_data: {
+                if ( !value.isArray() )
+                    Throw( DRM_BadArg, "Value must be an array of integers" );
+                std::vector<uint32_t> data_array;
+                for( Json::ValueConstIterator itr = value.begin(); itr != value.end(); itr++ )
+                    data_array.push_back( (*itr).asUInt() );
+                writeMailbox( eMailboxOffset::MB_USER, data_array );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       value.toStyledString());
+                break;
+            }
+            case ParameterKey::ws_retry_period_long: {
+                uint32_t retry_period = value.asUInt();
+                updateRuntimeSettings( [retry_period]( RuntimeSettings& settings ) {
+                    settings.ws_retry_period_long = retry_period;
+                } );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, retry_period );
+                break;
+            }
+            case ParameterKey::ws_retry_period_short: {
+                uint32_t retry_period = value.asUInt();
+                updateRuntimeSettings( [retry_period]( RuntimeSettings& settings ) {
+                    settings.ws_retry_period_short = retry_period;
+                } );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, retry_period );
+                break;
+            }
+            case ParameterKey::ws_request_timeout: {
+                uint32_t request_timeout = value.asUInt();
+                updateRuntimeSettings( [request_timeout]( RuntimeSettings& settings ) {
+                    settings.ws_request_timeout = request_timeout;
+                } );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id, request_timeout );
+                break;
+            }
+            case ParameterKey::thread_settings: {
+                // Applied to the threads started from now on
+                mThreadSettings.update( value );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       mThreadSettings.toJson().toStyledString() );
+                break;
+            }
+            case ParameterKey::trigger_async_callback: {
+                std::string custom_msg = value.asString();
+                Exception e( DRM_Debug, custom_msg );
+                reportAsyncError( e.what() );
+                Debug( "Set parameter '{}' (ID={}) to value: {}", key_str, key_id,
+                       custom_msg );
+                break;
+            }
+            case ParameterKey::bad_product_id: {
+                Debug( "Set parameter '{}' (ID={}) to random value", key_str, key_id );
+                mHeaderJsonRequest["product"]["name"] = "BAD_NAME_JUST_FOR_TEST";
+                mRequestTemplate.setHeader( mHeaderJsonRequest );
+                break;
+            }
+            case ParameterKey::bad_oauth2_token: {
+                Debug( "Set parameter '{}' (ID={}) to random value", key_str, key_id );
+                getDrmWSClient().setOAuth2token( "BAD_TOKEN" );
+                break;
+            }
+            case ParameterKey::log_message_level: {
+                int message_level = value.asInt();
+                if ( ( message_level < spdlog::level::trace)
+                  || ( message_level > spdlog::level::off) )
+                    Throw( DRM_BadArg, "log_message_level ({}) is out of range [{:d}:{:d}]",
+                            message_level, (int)spdlog::level::trace, (int)spdlog::level::off );
+                mDebugMessageLevel = static_cast<spdlog::level::level_enum>( message_level );
+                Debug( "Set parameter '{}' (ID={}) to value {}", key_str, key_id,
+                        message_level );
+                break;
+            }
+            case ParameterKey::log_message: {
+                std::string custom_msg = value.asString();
+                SPDLOG_LOGGER_CALL( sLogger, (spdlog::level::level_enum)mDebugMessageLevel, custom_msg);
+                break;
+            }
+            default:
+                Throw( DRM_BadArg, "Parameter '{}' cannot be overwritten", key_str );
+        }
+    }
+
+    void set( const Json::Value& json_value ) {
+        TRY
+            for( Json::ValueConstIterator it = json_value.begin() ; it != json_value.end() ; it++ )
+                setParameter( findParameterKey( it.key().asString() ), *it );
         CATCH_AND_THROW
     }
 
@@ -2036,58 +3209,57 @@ public:
 /*************************************/
 
 #define IMPL_GET_BODY \
-    Json::Value json_value; \
-    std::string key_str = findParameterString( key_id ); \
-    json_value[key_str] = Json::nullValue; \
-    get( json_value );
+    Json::Value value; \
+    TRY \
+        value = getParameter( key_id ); \
+    CATCH_AND_THROW
 
 template<> std::string DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    if ( json_value[key_str].isString() )
-        return json_value[key_str].asString();
-    return json_value[key_str].toStyledString();
+    if ( value.isString() )
+        return value.asString();
+    return value.toStyledString();
 }
 
 template<> bool DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asBool();
+    return value.asBool();
 }
 
 template<> int32_t DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asInt();
+    return value.asInt();
 }
 
 template<> uint32_t DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asUInt();
+    return value.asUInt();
 }
 
 template<> int64_t DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asInt64();
+    return value.asInt64();
 }
 
 template<> uint64_t DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asUInt64();
+    return value.asUInt64();
 }
 
 template<> float DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asFloat();
+    return value.asFloat();
 }
 
 template<> double DrmManager::Impl::get( const ParameterKey key_id ) const {
     IMPL_GET_BODY
-    return json_value[key_str].asDouble();
+    return value.asDouble();
 }
 
 #define IMPL_SET_BODY \
-    Json::Value json_value; \
-    std::string key_str = findParameterString( key_id ); \
-    json_value[key_str] = value; \
-    set( json_value );
+    TRY \
+        setParameter( key_id, Json::Value( value ) ); \
+    CATCH_AND_THROW
 
 
 template<> void DrmManager::Impl::set( const ParameterKey key_id, const std::string& value ) {
@@ -2107,17 +3279,15 @@ template<> void DrmManager::Impl::set( const ParameterKey key_id, const uint32_t
 }
 
 template<> void DrmManager::Impl::set( const ParameterKey key_id, const int64_t& value ) {
-    Json::Value json_value;
-    std::string key_str = findParameterString( key_id );
-    json_value[key_str] = Json::Int64( value );
-    set( json_value );
+    TRY
+        setParameter( key_id, Json::Int64( value ) );
+    CATCH_AND_THROW
 }
 
 template<> void DrmManager::Impl::set( const ParameterKey key_id, const uint64_t& value ) {
-    Json::Value json_value;
-    std::string key_str = findParameterString( key_id );
-    json_value[key_str] = Json::UInt64( value );
-    set( json_value );
+    TRY
+        setParameter( key_id, Json::UInt64( value ) );
+    CATCH_AND_THROW
 }
 
 template<> void DrmManager::Impl::set( const ParameterKey key_id, const float& value ) {
@@ -2141,6 +3311,10 @@ DrmManager::DrmManager( const std::string& conf_file_path,
     : pImpl( new Impl( conf_file_path, cred_file_path, read_register, write_register, async_error ) ) {
 }
 
+DrmManager::DrmManager( Impl* impl )
+    : pImpl( impl ) {
+}
+
 DrmManager::~DrmManager() {
     delete pImpl;
     pImpl = nullptr;
@@ -2155,6 +3329,10 @@ void DrmManager::deactivate( const bool& pause_session ) {
     pImpl->deactivate( pause_session );
 }
 
+void DrmManager::setAsynchErrorExecutor( AsynchErrorExecutor executor ) {
+    pImpl->setAsyncErrorExecutor( executor );
+}
+
 void DrmManager::get( Json::Value& json_value ) const {
     pImpl->get( json_value );
 }
@@ -2198,5 +3376,104 @@ template<> void DrmManager::set( const ParameterKey key, const uint64_t& value )
 template<> void DrmManager::set( const ParameterKey key, const float& value ) { pImpl->set<float>( key, value ); }
 template<> void DrmManager::set( const ParameterKey key, const double& value ) { pImpl->set<double>( key, value ); }
 
+
+/*************************************/
+// DrmManagerGroup class definition
+/*************************************/
+
+class DRM_LOCAL DrmManagerGroup::Impl {
+public:
+
+    std::shared_ptr<GroupResources> mResources;
+    std::vector<std::unique_ptr<DrmManager>> mSlots;    ///< Destroyed before the shared resources
+
+    // Run operation on all slots in parallel, then throw the error of the first failing slot
+    void forEachSlot( const std::string& operation_name, const std::function<void( DrmManager& )>& operation ) {
+        std::vector<std::future<void>> results;
+        for( auto& slot: mSlots ) {
+            DrmManager* manager = slot.get();
+            results.push_back( std::async( std::launch::async, [ &operation, manager ]() { operation( *manager ); } ) );
+        }
+        std::exception_ptr first_error;
+        size_t first_index = 0;
+        size_t nb_errors = 0;
+        for( size_t i = 0; i < results.size(); i++ ) {
+            try {
+                results[i].get();
+            } catch( ... ) {
+                if ( !first_error ) {
+                    first_error = std::current_exception();
+                    first_index = i;
+                }
+                nb_errors++;
+            }
+        }
+        if ( !first_error )
+            return;
+        try {
+            std::rethrow_exception( first_error );
+        } catch( const Exception& e ) {
+            Throw( e.getErrCode(), "Failed to {} {} of {} slots, first error on slot #{}: {}",
+                    operation_name, nb_errors, mSlots.size(), first_index, e.what() );
+        }
+    }
+};
+
+
+DrmManagerGroup::DrmManagerGroup( const std::string& conf_file_path,
+                                  const std::string& cred_file_path,
+                                  const std::vector<SlotCallbacks>& slots )
+    : pImpl( new Impl ) {
+    try {
+        if ( slots.empty() )
+            Throw( DRM_BadArg, "A DRM manager group requires at least one slot" );
+        auto resources = std::make_shared<GroupResources>();
+        resources->config = DrmConfig::load( conf_file_path, cred_file_path );
+        resources->ws_client = std::make_shared<DrmWSClient>( *resources->config );
+        resources->ws_client->setStatistics( resources->oauth2_statistics, resources->license_statistics );
+        ThreadSettings thread_settings;
+        thread_settings.update( resources->config->settings );
+        resources->scheduler.reset( new Scheduler( thread_settings ) );
+        // A few workers run the continuity of all slots: a worker is held during a license request only
+        const size_t max_workers = 4;
+        resources->workers.reset( new WorkerPool( std::min( slots.size(), max_workers ), thread_settings ) );
+        pImpl->mResources = resources;
+        // Slots are initialized one by one because they share the logging setup
+        for( const SlotCallbacks& slot: slots )
+            pImpl->mSlots.emplace_back( new DrmManager( new DrmManager::Impl( conf_file_path, cred_file_path,
+                    slot.read_register, slot.write_register, slot.async_error, resources ) ) );
+    } catch( ... ) {
+        delete pImpl;
+        throw;
+    }
+}
+
+DrmManagerGroup::~DrmManagerGroup() {
+    delete pImpl;
+    pImpl = nullptr;
+}
+
+size_t DrmManagerGroup::size() const {
+    return pImpl->mSlots.size();
+}
+
+DrmManager& DrmManagerGroup::getSlot( const size_t& index ) {
+    if ( index >= pImpl->mSlots.size() )
+        Throw( DRM_BadArg, "Slot index {} is out of range: the group has {} slots", index, pImpl->mSlots.size() );
+    return *pImpl->mSlots[index];
+}
+
+void DrmManagerGroup::activate( const bool& resume_session_request ) {
+    pImpl->forEachSlot( "activate", [ &resume_session_request ]( DrmManager& slot ) {
+        slot.activate( resume_session_request );
+    });
+}
+
+void DrmManagerGroup::deactivate( const bool& pause_session_request ) {
+    pImpl->forEachSlot( "deactivate", [ &pause_session_request ]( DrmManager& slot ) {
+        slot.deactivate( pause_session_request );
+    });
+}
+
 }
 }
@@ -0,0 +1,66 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <chrono>
+#include <unistd.h>
+
+#include "utils.h"
+#include "event_log.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+EventLog::EventLog( const std::string& file_path, const size_t& rotating_size, const size_t& rotating_num ) {
+    if ( !makeDirs( getDirName( file_path ) ) )
+        Throw( DRM_ExternFail, "Failed to create event log file {}", file_path );
+    try {
+        auto sink = std::make_shared<spdlog::sinks::rotating_file_sink_mt>( file_path, rotating_size, rotating_num );
+        // The logger is not registered so that it never mixes with the default logger
+        mLogger = std::make_shared<spdlog::logger>( "drmlib_events", sink );
+        mLogger->set_pattern( "%v" );
+        mLogger->set_level( spdlog::level::info );
+        mLogger->flush_on( spdlog::level::info );
+    } catch( const spdlog::spdlog_ex& ex ) {
+        Throw( DRM_ExternFail, "Failed to create event log file {}: {}", file_path, ex.what() );
+    }
+    Debug( "Created event log file '{}'", file_path );
+}
+
+EventLog::~EventLog() {
+    mLogger->flush();
+}
+
+void EventLog::setSessionID( const std::string& session_id ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    mSessionID = session_id;
+}
+
+void EventLog::write( const std::string& event, const Json::Value& fields ) {
+    Json::Value node = fields;
+    node["time"] = getISO8601Time( std::chrono::system_clock::now() );
+    node["event"] = event;
+    node["pid"] = (Json::Int)getpid();
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        if ( !mSessionID.empty() )
+            node["session"] = mSessionID;
+    }
+    mLogger->info( "{}", saveJsonToString( node ) );
+}
+
+}
+}
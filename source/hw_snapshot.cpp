@@ -0,0 +1,138 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
+#include "log.h"
+#include "utils.h"
+#include "hw_snapshot.h"
+#include "HAL/DrmControllerRegisters.hpp"
+
+namespace Accelize {
+namespace DRM {
+
+
+static const char cPageRegisterName[] = "DrmPageRegister";
+static const char cRegisterLineName[] = "DrmRegisterLine";
+static const size_t cRegisterLineNameSize = sizeof( cRegisterLineName ) - 1;
+
+
+const std::vector<std::string> HwSnapshot::cPageNames = {
+        "ctrlreg", "vlnvfile", "licfile", "tracefile", "meteringfile", "mailbox" };
+
+
+uint32_t HwSnapshot::getRegisterOffset( const std::string& reg_name ) {
+    if ( reg_name == cPageRegisterName )
+        return 0;
+    if ( reg_name.compare( 0, cRegisterLineNameSize, cRegisterLineName ) == 0 )
+        return (uint32_t)std::stoul( reg_name.substr( cRegisterLineNameSize ) ) * 4 + 4;
+    Unreachable( "Unsupported regName argument: ", reg_name ); //LCOV_EXCL_LINE
+}
+
+std::vector<uint32_t> HwSnapshot::getReportLayout(
+        const DrmControllerLibrary::tDrmReadRegisterFunction& read_register,
+        const DrmControllerLibrary::tDrmWriteRegisterFunction& write_register ) {
+    std::vector<uint32_t> layout( cPageNames.size(), 0 );
+    uint32_t page = 0;
+
+    // Run the report once on the hardware and record the highest register line read in each page
+    auto recording_read = [&]( const std::string& reg_name, unsigned int& value ) -> unsigned int {
+        unsigned int ret = read_register( reg_name, value );
+        uint32_t offset = getRegisterOffset( reg_name );
+        if ( ( offset > 0 ) && ( page < layout.size() ) )
+            layout[page] = std::max( layout[page], offset / 4 );
+        return ret;
+    };
+    auto recording_write = [&]( const std::string& reg_name, unsigned int value ) -> unsigned int {
+        if ( getRegisterOffset( reg_name ) == 0 )
+            page = value;
+        return write_register( reg_name, value );
+    };
+    {
+        DrmControllerLibrary::DrmControllerRegisters registers( recording_read, recording_write );
+        std::ostream null_stream( nullptr );    // Formatting into a stream without buffer does nothing
+        registers.printHwReport( null_stream );
+    }
+    Debug( "DRM Controller report layout: {} register lines per page",
+            std::accumulate( layout.begin(), layout.end(), std::string(),
+                    []( const std::string& str, uint32_t n ) { return str + ( str.empty() ? "" : "/" ) + std::to_string( n ); } ) );
+    return layout;
+}
+
+void HwSnapshot::capture( const DrmControllerLibrary::tDrmReadRegisterFunction& read_register,
+        const DrmControllerLibrary::tDrmWriteRegisterFunction& write_register,
+        const std::vector<uint32_t>& layout ) {
+    mTime = std::chrono::system_clock::now();
+    mPages.resize( layout.size() );
+    for( uint32_t page = 0; page < layout.size(); page++ ) {
+        std::vector<uint32_t>& registers = mPages[page];
+        registers.resize( layout[page] );
+        if ( registers.empty() )
+            continue;
+        if ( write_register( cPageRegisterName, page ) )
+            Throw( DRM_CtlrError, "Failed to select DRM Controller page {}", page );
+        for( uint32_t line = 0; line < registers.size(); line++ ) {
+            unsigned int value = 0;
+            if ( read_register( cRegisterLineName + std::to_string( line ), value ) )
+                Throw( DRM_CtlrError, "Failed to read register line {} of DRM Controller page {}", line, page );
+            registers[line] = value;
+        }
+    }
+}
+
+Json::Value HwSnapshot::toJson() const {
+    Json::Value node;
+    node["time"] = getISO8601Time( mTime );
+    Json::Value& pages = node["pages"];
+    pages = Json::objectValue;
+    for( uint32_t page = 0; page < mPages.size(); page++ ) {
+        Json::Value& registers = pages[ cPageNames[page] ];
+        registers = Json::arrayValue;
+        for( const uint32_t& value: mPages[page] )
+            registers.append( value );
+    }
+    return node;
+}
+
+std::string HwSnapshot::toText() const {
+    uint32_t page = 0;
+
+    // Replay the report on the snapshot: register lines out of the snapshot read as 0
+    auto snapshot_read = [&]( const std::string& reg_name, unsigned int& value ) -> unsigned int {
+        uint32_t offset = getRegisterOffset( reg_name );
+        if ( offset == 0 )
+            value = page;
+        else if ( ( page < mPages.size() ) && ( offset / 4 <= mPages[page].size() ) )
+            value = mPages[page][ offset / 4 - 1 ];
+        else
+            value = 0;
+        return 0;
+    };
+    auto snapshot_write = [&]( const std::string& reg_name, unsigned int value ) -> unsigned int {
+        if ( getRegisterOffset( reg_name ) == 0 )
+            page = value;
+        return 0;
+    };
+    std::stringstream ss;
+    DrmControllerLibrary::DrmControllerRegisters registers( snapshot_read, snapshot_write );
+    registers.printHwReport( ss );
+    return ss.str();
+}
+
+}
+}
@@ -23,6 +23,9 @@ namespace Accelize {
     namespace DRM {
 
         std::shared_ptr<spdlog::logger> sLogger;
+        std::shared_ptr<spdlog::details::thread_pool> sLogThreadPool;
+        std::mutex sLogAsyncMutex;
+        uint32_t sLogAsyncUsers = 0;
 
     }
 }
@@ -0,0 +1,144 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+#include "log.h"
+#include "utils.h"
+#include "metering_journal.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+static const char cEntryPrefix[] = "metering_";
+static const char cEntrySuffix[] = ".json";
+
+
+static bool endsWith( const std::string& str, const std::string& suffix ) {
+    return ( str.size() >= suffix.size() )
+            && ( str.compare( str.size() - suffix.size(), suffix.size(), suffix ) == 0 );
+}
+
+
+MeteringJournal::MeteringJournal( const std::string& dir_path ): mDirPath( dir_path ) {
+    if ( !makeDirs( mDirPath, S_IRWXU ) )
+        Throw( DRM_ExternFail, "Failed to create metering journal directory {}", mDirPath );
+    Debug( "Metering journal directory: {}", mDirPath );
+}
+
+std::string MeteringJournal::append( const std::string& content, const std::string& session_id ) const {
+    // Entry names sort in creation order
+    int64_t timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::system_clock::now().time_since_epoch() ).count();
+    std::string name = fmt::format( "{}{:020d}_{}_{}{}", cEntryPrefix, timestamp,
+            session_id, getpid(), cEntrySuffix );
+    std::string entry_path = mDirPath + "/" + name;
+    std::string tmp_path = entry_path + ".tmp";
+
+    // Write a temporary file then rename it so that readers never see a partial entry
+    int fd = open( tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR );
+    if ( fd < 0 )
+        Throw( DRM_ExternFail, "Failed to create metering journal entry {}: {}", tmp_path, strerror( errno ) );
+    bool ok = ( write( fd, content.c_str(), content.size() ) == (ssize_t)content.size() )
+            && ( fsync( fd ) == 0 );
+    close( fd );
+    if ( !ok || ( rename( tmp_path.c_str(), entry_path.c_str() ) != 0 ) ) {
+        int err = errno;
+        unlink( tmp_path.c_str() );
+        Throw( DRM_ExternFail, "Failed to write metering journal entry {}: {}", entry_path, strerror( err ) );
+    }
+
+    // Make the rename durable
+    int dir_fd = open( mDirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    if ( dir_fd >= 0 ) {
+        fsync( dir_fd );
+        close( dir_fd );
+    }
+    Debug( "Appended metering journal entry {}", entry_path );
+    return entry_path;
+}
+
+std::vector<std::string> MeteringJournal::list() const {
+    std::vector<std::string> entries;
+    DIR* dir = opendir( mDirPath.c_str() );
+    if ( dir == nullptr ) {
+        Warning( "Failed to open metering journal directory {}: {}", mDirPath, strerror( errno ) );
+        return entries;
+    }
+    struct dirent* ent;
+    while ( ( ent = readdir( dir ) ) != nullptr ) {
+        std::string name( ent->d_name );
+        if ( ( name.compare( 0, sizeof( cEntryPrefix ) - 1, cEntryPrefix ) == 0 ) && endsWith( name, cEntrySuffix ) )
+            entries.push_back( mDirPath + "/" + name );
+    }
+    closedir( dir );
+    std::sort( entries.begin(), entries.end() );
+    return entries;
+}
+
+int MeteringJournal::lock( const std::string& entry_path ) const {
+    int fd = open( entry_path.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+        return -1;  // Already uploaded by another process
+    if ( flock( fd, LOCK_EX | LOCK_NB ) != 0 ) {
+        close( fd );
+        return -1;
+    }
+    // The entry may have been removed between open and lock
+    struct stat info;
+    if ( ( stat( entry_path.c_str(), &info ) != 0 ) ) {
+        close( fd );
+        return -1;
+    }
+    return fd;
+}
+
+void MeteringJournal::unlock( const int& fd ) const {
+    if ( fd < 0 )
+        return;
+    flock( fd, LOCK_UN );
+    close( fd );
+}
+
+Json::Value MeteringJournal::read( const std::string& entry_path ) const {
+    return parseJsonFile( entry_path );
+}
+
+void MeteringJournal::remove( const std::string& entry_path ) const {
+    if ( unlink( entry_path.c_str() ) != 0 )
+        Warning( "Failed to remove metering journal entry {}: {}", entry_path, strerror( errno ) );
+    else
+        Debug( "Removed metering journal entry {}", entry_path );
+}
+
+void MeteringJournal::reject( const std::string& entry_path ) const {
+    std::string rejected_path = entry_path + ".rejected";
+    if ( rename( entry_path.c_str(), rejected_path.c_str() ) != 0 )
+        Warning( "Failed to reject metering journal entry {}: {}", entry_path, strerror( errno ) );
+    else
+        Warning( "Metering journal entry has been moved to {}", rejected_path );
+}
+
+}
+}
@@ -0,0 +1,76 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstdio>
+
+#include "utils.h"
+#include "metering_request.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+// Append ,"key":"value" to out, escaping value as a JSON string
+static void appendStringField( std::string& out, const char* key, const std::string& value ) {
+    out += ",\"";
+    out += key;
+    out += "\":\"";
+    for( const char& c: value ) {
+        if ( ( c == '"' ) || ( c == '\\' ) ) {
+            out += '\\';
+            out += c;
+        } else if ( (unsigned char)c < 0x20 ) {
+            char escaped[8];
+            snprintf( escaped, sizeof( escaped ), "\\u%04x", (unsigned int)c );
+            out += escaped;
+        } else {
+            out += c;
+        }
+    }
+    out += '"';
+}
+
+
+void MeteringRequestTemplate::setHeader( const Json::Value& header ) {
+    mPrefix = saveJsonToString( header );
+    mPrefix.erase( mPrefix.find_last_of( '}' ) );
+    mDna = header.get( "dna", "" ).asString();
+}
+
+void MeteringRequestTemplate::build( std::string& body, const char* request, const std::string& saas_challenge,
+        const std::string& session_id, const std::string& metering_file, const int32_t& drm_frequency ) const {
+    body.clear();
+    body.reserve( mPrefix.size() + saas_challenge.size() + metering_file.size() + 128 );
+    // The first field is a constant so that the others always start with a comma
+    body += mPrefix;
+    if ( body.back() != '{' )
+        body += ',';
+    body += "\"request\":\"";
+    body += request;
+    body += '"';
+    appendStringField( body, "saasChallenge", saas_challenge );
+    if ( !session_id.empty() )
+        appendStringField( body, "sessionId", session_id );
+    appendStringField( body, "meteringFile", metering_file );
+    if ( drm_frequency != 0 ) {
+        body += ",\"drm_frequency\":";
+        body += std::to_string( drm_frequency );
+    }
+    body += '}';
+}
+
+}
+}
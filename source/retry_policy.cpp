@@ -0,0 +1,145 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+
+#include "log.h"
+#include "retry_policy.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+std::unique_ptr<RetryPolicy> RetryPolicy::create( const std::string& name, const uint32_t& max_attempts ) {
+    if ( name == "fixed" )
+        return std::unique_ptr<RetryPolicy>( new FixedRetryPolicy( max_attempts ) );
+    if ( name == "exponential" )
+        return std::unique_ptr<RetryPolicy>( new ExponentialBackoffRetryPolicy( max_attempts ) );
+    Throw( DRM_BadArg, "Unsupported retry policy '{}': must be 'fixed' or 'exponential'", name );
+}
+
+
+bool FixedRetryPolicy::getNextDelay( const uint32_t& attempt, const TClock::duration& time_left,
+        const TClock::duration& short_period, const TClock::duration& long_period,
+        TClock::duration& delay ) {
+    if ( ( mMaxAttempts != 0 ) && ( attempt >= mMaxAttempts ) )
+        return false;
+    if ( ( long_period == TClock::duration::zero() ) || ( time_left < long_period ) )
+        delay = short_period;
+    else
+        delay = long_period;
+    return true;
+}
+
+
+ExponentialBackoffRetryPolicy::ExponentialBackoffRetryPolicy( const uint32_t& max_attempts )
+        : mMaxAttempts( max_attempts ) {
+    std::random_device rd;
+    mRandomGenerator.seed( ( (uint64_t)rd() << 32 ) ^ rd() );
+}
+
+bool ExponentialBackoffRetryPolicy::getNextDelay( const uint32_t& attempt, const TClock::duration& time_left,
+        const TClock::duration& short_period, const TClock::duration& long_period,
+        TClock::duration& delay ) {
+    if ( ( mMaxAttempts != 0 ) && ( attempt >= mMaxAttempts ) )
+        return false;
+    TClock::duration cap = ( long_period == TClock::duration::zero() ) ? short_period : long_period;
+    // Backoff ceiling: short_period * 2^(attempt-1), bounded by the cap
+    TClock::duration ceiling = short_period;
+    for( uint32_t i = 1; ( i < attempt ) && ( ceiling < cap ); i++ )
+        ceiling *= 2;
+    ceiling = std::min( ceiling, cap );
+    // Do not plan beyond the deadline
+    if ( time_left > TClock::duration::zero() )
+        ceiling = std::min( ceiling, time_left );
+    // Never retry immediately
+    TClock::duration floor = std::min( short_period / 10, ceiling );
+    std::uniform_int_distribution<TClock::rep> distribution( floor.count(), ceiling.count() );
+    delay = TClock::duration( distribution( mRandomGenerator ) );
+    return true;
+}
+
+
+CircuitBreaker::CircuitBreaker( const uint32_t& threshold, const uint32_t& cooldown_s ) {
+    configure( threshold, cooldown_s );
+}
+
+void CircuitBreaker::configure( const uint32_t& threshold, const uint32_t& cooldown_s ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    mThreshold = threshold;
+    mCooldown = std::chrono::seconds( cooldown_s );
+}
+
+bool CircuitBreaker::allowRequest( TClock::time_point& retry_time ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    switch( mState ) {
+        case eState::CLOSED:
+            return true;
+        case eState::OPEN:
+            if ( TClock::now() < mOpenUntil ) {
+                retry_time = mOpenUntil;
+                return false;
+            }
+            // Cool-down elapsed: let a single probe request through
+            mState = eState::HALF_OPEN;
+            Info( "Circuit breaker is half-open: probing License Web Service" );
+            return true;
+        case eState::HALF_OPEN:
+        default:
+            // A probe is already pending
+            retry_time = TClock::now() + mCooldown;
+            return false;
+    }
+}
+
+void CircuitBreaker::recordSuccess() {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mState != eState::CLOSED )
+        Info( "Circuit breaker is closed: License Web Service has recovered" );
+    mState = eState::CLOSED;
+    mFailureCount = 0;
+}
+
+void CircuitBreaker::recordFailure() {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mThreshold == 0 )
+        return;
+    mFailureCount ++;
+    if ( ( mState == eState::HALF_OPEN ) || ( mFailureCount >= mThreshold ) ) {
+        if ( mState != eState::OPEN )
+            Warning( "Circuit breaker is open after {} consecutive failures: no request is sent during {} seconds",
+                    mFailureCount, std::chrono::duration_cast<std::chrono::seconds>( mCooldown ).count() );
+        mState = eState::OPEN;
+        mOpenUntil = TClock::now() + mCooldown;
+    }
+}
+
+void CircuitBreaker::recordNeutral() {
+    std::lock_guard<std::mutex> lock( mMutex );
+    if ( mState != eState::HALF_OPEN )
+        return;
+    // Stay open but let the next request probe again
+    mState = eState::OPEN;
+    mOpenUntil = TClock::now();
+}
+
+CircuitBreaker::eState CircuitBreaker::getState() const {
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mState;
+}
+
+}
+}
@@ -0,0 +1,142 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "log.h"
+#include "scheduler.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+Scheduler::Scheduler( const ThreadSettings& settings ) {
+    mWorker = startThread( settings, "drm_scheduler", [ this ]() { run(); } );
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mStopRequest = true;
+    }
+    mWheelCondVar.notify_all();
+    mWorker.get();
+    if ( !mWheel.empty() )
+        Debug( "Scheduler stopped with {} pending tasks", mWheel.size() );
+}
+
+std::shared_ptr<Scheduler> Scheduler::getShared( const ThreadSettings& settings ) {
+    static std::mutex shared_mutex;
+    static std::weak_ptr<Scheduler> shared_scheduler;
+    std::lock_guard<std::mutex> lock( shared_mutex );
+    std::shared_ptr<Scheduler> scheduler = shared_scheduler.lock();
+    if ( !scheduler ) {
+        scheduler = std::make_shared<Scheduler>( settings );
+        shared_scheduler = scheduler;
+    }
+    return scheduler;
+}
+
+void Scheduler::run() {
+    std::unique_lock<std::mutex> lock( mMutex );
+    mWorkerId = std::this_thread::get_id();
+    while ( !mStopRequest ) {
+        TClock::time_point wakeup = mWheel.getNextWakeup();
+        if ( wakeup == TClock::time_point::max() ) {
+            mWheelCondVar.wait( lock );
+            continue;
+        }
+        if ( wakeup > TClock::now() ) {
+            mWheelCondVar.wait_until( lock, wakeup );
+            continue;
+        }
+        mExpired.clear();
+        mWheel.advance( TClock::now(), mExpired );
+        for( mExpiredNext = 0; ( mExpiredNext < mExpired.size() ) && !mStopRequest; ) {
+            TTaskId id = mExpired[mExpiredNext].first;
+            TTask task = std::move( mExpired[mExpiredNext].second );
+            mExpiredNext++;
+            if ( id == 0 )  // Canceled after it expired
+                continue;
+            mRunningId = id;
+            lock.unlock();
+            try {
+                task();
+            } catch( const std::exception& e ) {
+                Error( "Scheduled task failed: {}", e.what() );
+            }
+            lock.lock();
+            // Periodic tasks run again unless canceled meanwhile
+            auto periodic = mPeriods.find( id );
+            if ( periodic != mPeriods.end() ) {
+                TClock::time_point now = TClock::now();
+                TClock::time_point& next = periodic->second.second;
+                next += periodic->second.first;
+                if ( next < now )
+                    next = now + periodic->second.first;
+                mWheel.add( id, next, std::move( task ) );
+            }
+            mRunningId = 0;
+            mDoneCondVar.notify_all();
+        }
+    }
+}
+
+Scheduler::TTaskId Scheduler::schedule( const TClock::time_point& time, TTask task ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    TTaskId id = mNextId++;
+    // Wake the worker only if the new task is the next one to run
+    bool is_next = time < mWheel.getNextWakeup();
+    mWheel.add( id, time, std::move( task ) );
+    if ( is_next )
+        mWheelCondVar.notify_all();
+    return id;
+}
+
+Scheduler::TTaskId Scheduler::schedulePeriodic( const TClock::time_point& time, const TClock::duration& period,
+        TTask task ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    TTaskId id = mNextId++;
+    mPeriods[id] = std::make_pair( period, time );
+    bool is_next = time < mWheel.getNextWakeup();
+    mWheel.add( id, time, std::move( task ) );
+    if ( is_next )
+        mWheelCondVar.notify_all();
+    return id;
+}
+
+bool Scheduler::cancel( const TTaskId& id ) {
+    std::unique_lock<std::mutex> lock( mMutex );
+    bool is_periodic = mPeriods.erase( id ) > 0;
+    if ( mWheel.remove( id ) )
+        return true;
+    for( size_t i = mExpiredNext; i < mExpired.size(); i++ ) {
+        if ( mExpired[i].first == id ) {
+            mExpired[i].first = 0;
+            return true;
+        }
+    }
+    // A task canceling itself must not wait for its own end
+    if ( ( mRunningId == id ) && ( std::this_thread::get_id() != mWorkerId ) )
+        mDoneCondVar.wait( lock, [ this, &id ]{ return mRunningId != id; } );
+    return is_periodic;
+}
+
+size_t Scheduler::size() const {
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mWheel.size();
+}
+
+}
+}
@@ -0,0 +1,174 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <limits.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "log.h"
+#include "utils.h"
+#include "thread_settings.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+static int getSchedPolicy( const std::string& name ) {
+    if ( name == "other" )
+        return SCHED_OTHER;
+#ifdef SCHED_BATCH
+    if ( name == "batch" )
+        return SCHED_BATCH;
+#endif
+#ifdef SCHED_IDLE
+    if ( name == "idle" )
+        return SCHED_IDLE;
+#endif
+    if ( name == "fifo" )
+        return SCHED_FIFO;
+    if ( name == "rr" )
+        return SCHED_RR;
+    Throw( DRM_BadArg, "Unsupported thread_sched_policy '{}': must be 'other', 'batch', 'idle', 'fifo' or 'rr'",
+            name );
+}
+
+
+void ThreadSettings::update( const Json::Value& settings ) {
+    // Settings are left unchanged if a value is invalid
+    ThreadSettings updated( *this );
+    updated.name = JVgetOptional( settings, "thread_name", Json::stringValue, updated.name ).asString();
+    const Json::Value& cpus = JVgetOptional( settings, "thread_cpu_affinity", Json::arrayValue );
+    if ( !cpus.isNull() ) {
+        updated.cpu_affinity.clear();
+        for( const Json::Value& cpu: cpus ) {
+            if ( !cpu.isUInt() || ( cpu.asUInt() >= CPU_SETSIZE ) )
+                Throw( DRM_BadArg, "thread_cpu_affinity must be a list of CPU numbers lower than {}: {}",
+                        CPU_SETSIZE, cpus.toStyledString() );
+            updated.cpu_affinity.push_back( cpu.asUInt() );
+        }
+    }
+    updated.nice = JVgetOptional( settings, "thread_nice", Json::intValue, updated.nice ).asInt();
+    updated.sched_policy = JVgetOptional( settings, "thread_sched_policy", Json::stringValue,
+            updated.sched_policy ).asString();
+    updated.sched_priority = JVgetOptional( settings, "thread_sched_priority", Json::intValue,
+            updated.sched_priority ).asInt();
+    updated.stack_size = JVgetOptional( settings, "thread_stack_size", Json::uintValue,
+            (Json::UInt64)updated.stack_size ).asUInt64();
+
+    if ( ( updated.nice < -20 ) || ( updated.nice > 19 ) )
+        Throw( DRM_BadArg, "thread_nice ({}) must be between -20 and 19", updated.nice );
+    if ( !updated.sched_policy.empty() ) {
+        int policy = getSchedPolicy( updated.sched_policy );
+        int min_priority = sched_get_priority_min( policy );
+        int max_priority = sched_get_priority_max( policy );
+        if ( ( updated.sched_priority < min_priority ) || ( updated.sched_priority > max_priority ) )
+            Throw( DRM_BadArg, "thread_sched_priority ({}) must be between {} and {} with the '{}' policy",
+                    updated.sched_priority, min_priority, max_priority, updated.sched_policy );
+    }
+    if ( ( updated.stack_size != 0 ) && ( updated.stack_size < (size_t)PTHREAD_STACK_MIN ) )
+        Throw( DRM_BadArg, "thread_stack_size ({}) must be 0 or at least {} bytes", updated.stack_size,
+                PTHREAD_STACK_MIN );
+    *this = updated;
+}
+
+Json::Value ThreadSettings::toJson() const {
+    Json::Value node;
+    node["thread_name"] = name;
+    node["thread_cpu_affinity"] = Json::arrayValue;
+    for( const uint32_t& cpu: cpu_affinity )
+        node["thread_cpu_affinity"].append( cpu );
+    node["thread_nice"] = nice;
+    node["thread_sched_policy"] = sched_policy;
+    node["thread_sched_priority"] = sched_priority;
+    node["thread_stack_size"] = (Json::UInt64)stack_size;
+    return node;
+}
+
+void ThreadSettings::apply( const std::string& thread_name ) const {
+    // Failures are not fatal: the thread runs with the settings inherited from the process
+#ifdef __linux__
+    pthread_setname_np( pthread_self(), thread_name.substr( 0, 15 ).c_str() );
+    if ( !cpu_affinity.empty() ) {
+        cpu_set_t cpus;
+        CPU_ZERO( &cpus );
+        for( const uint32_t& cpu: cpu_affinity )
+            CPU_SET( cpu, &cpus );
+        int err = pthread_setaffinity_np( pthread_self(), sizeof( cpus ), &cpus );
+        if ( err )
+            Warning( "Failed to set CPU affinity of thread {}: {}", thread_name, strerror( err ) );
+    }
+#endif
+    if ( !sched_policy.empty() ) {
+        sched_param param;
+        param.sched_priority = sched_priority;
+        int err = pthread_setschedparam( pthread_self(), getSchedPolicy( sched_policy ), &param );
+        if ( err )
+            Warning( "Failed to set scheduling policy of thread {} to '{}' with priority {}: {}",
+                    thread_name, sched_policy, sched_priority, strerror( err ) );
+    }
+#ifdef __linux__
+    // On Linux the nice value applies to the thread ID, not to the whole process
+    if ( ( nice != 0 ) && ( setpriority( PRIO_PROCESS, (id_t)syscall( SYS_gettid ), nice ) != 0 ) )
+        Warning( "Failed to set nice value of thread {} to {}: {}", thread_name, nice, strerror( errno ) );
+#endif
+    Debug( "Started thread {}", thread_name );
+}
+
+
+struct ThreadStart {
+    ThreadSettings settings;
+    std::string name;
+    std::packaged_task<void()> task;
+};
+
+static void* runThread( void* arg ) {
+    std::unique_ptr<ThreadStart> start( static_cast<ThreadStart*>( arg ) );
+    start->settings.apply( start->name );
+    start->task();
+    return nullptr;
+}
+
+std::future<void> startThread( const ThreadSettings& settings, const std::string& thread_name,
+        std::function<void()> function ) {
+    // Like std::async, the returned future gets the end of the function or its exception
+    std::unique_ptr<ThreadStart> start( new ThreadStart{ settings, thread_name,
+            std::packaged_task<void()>( std::move( function ) ) } );
+    std::future<void> result = start->task.get_future();
+
+    pthread_attr_t attr;
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    int err = 0;
+    if ( settings.stack_size != 0 )
+        err = pthread_attr_setstacksize( &attr, settings.stack_size );
+    pthread_t thread;
+    if ( !err )
+        err = pthread_create( &thread, &attr, runThread, start.get() );
+    pthread_attr_destroy( &attr );
+    if ( err )
+        Throw( DRM_ExternFail, "Failed to start thread {}: {}", thread_name, strerror( err ) );
+    start.release();    // Now owned by the thread
+    return result;
+}
+
+}
+}
@@ -0,0 +1,175 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <algorithm>
+#include <limits>
+
+#include "timer_wheel.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+static const uint64_t cNoTick = std::numeric_limits<uint64_t>::max();
+
+
+TimerWheel::TimerWheel( const TClock::duration& resolution, const TClock::time_point& start )
+    : mStart( start ), mResolution( resolution ) {
+    mOccupied.fill( 0 );
+}
+
+uint64_t TimerWheel::toTick( const TClock::time_point& time ) const {
+    if ( time <= mStart )
+        return 0;
+    // Round up so that a timer never expires early
+    return (uint64_t)( ( time - mStart + mResolution - TClock::duration( 1 ) ) / mResolution );
+}
+
+void TimerWheel::insert( Entry&& entry ) {
+    entry.tick = std::max( entry.tick, mCurrentTick );
+    Location location;
+    location.level = cLevels;
+    location.index = 0;
+    for( uint32_t level = 0; level < cLevels; level++ ) {
+        uint32_t block_shift = cSlotBits * ( level + 1 );
+        if ( ( entry.tick >> block_shift ) == ( mCurrentTick >> block_shift ) ) {
+            location.level = level;
+            location.index = ( entry.tick >> ( cSlotBits * level ) ) & ( cSlots - 1 );
+            break;
+        }
+    }
+    if ( location.level < cLevels ) {
+        location.slot = &mSlots[location.level][location.index];
+        mOccupied[location.level] |= 1ULL << location.index;
+    } else {
+        location.slot = &mOverflow;
+    }
+    TTimerId id = entry.id;
+    location.it = location.slot->insert( location.slot->end(), std::move( entry ) );
+    mLocations[id] = location;
+}
+
+void TimerWheel::unlink( const Location& location ) {
+    location.slot->erase( location.it );
+    if ( ( location.level < cLevels ) && location.slot->empty() )
+        mOccupied[location.level] &= ~( 1ULL << location.index );
+}
+
+void TimerWheel::cascade( const uint32_t& level, const uint32_t& index ) {
+    TSlot entries;
+    entries.swap( mSlots[level][index] );
+    mOccupied[level] &= ~( 1ULL << index );
+    for( Entry& entry: entries )
+        insert( std::move( entry ) );
+}
+
+uint64_t TimerWheel::getNextEventTick() const {
+    uint64_t next = cNoTick;
+
+    // Next timer to expire in the current level 0 block, including the current tick
+    uint32_t index = mCurrentTick & ( cSlots - 1 );
+    uint64_t mask = mOccupied[0] & ( ~0ULL << index );
+    if ( mask )
+        next = ( mCurrentTick & ~(uint64_t)( cSlots - 1 ) ) + __builtin_ctzll( mask );
+
+    // Next slot to cascade in upper levels: the first tick of its range
+    for( uint32_t level = 1; level < cLevels; level++ ) {
+        uint32_t shift = cSlotBits * level;
+        index = ( mCurrentTick >> shift ) & ( cSlots - 1 );
+        mask = ( index == cSlots - 1 ) ? 0 : ( mOccupied[level] & ( ~0ULL << ( index + 1 ) ) );
+        if ( mask ) {
+            uint64_t block_start = ( mCurrentTick >> ( shift + cSlotBits ) ) << ( shift + cSlotBits );
+            next = std::min( next, block_start + ( (uint64_t)__builtin_ctzll( mask ) << shift ) );
+        }
+    }
+
+    // Overflow timers enter the wheel at the start of the top level block containing them
+    if ( !mOverflow.empty() ) {
+        uint32_t shift = cSlotBits * cLevels;
+        uint64_t min_tick = std::min_element( mOverflow.begin(), mOverflow.end(),
+                []( const Entry& a, const Entry& b ) { return a.tick < b.tick; } )->tick;
+        next = std::min( next, std::max( mCurrentTick, ( min_tick >> shift ) << shift ) );
+    }
+    return next;
+}
+
+void TimerWheel::add( const TTimerId& id, const TClock::time_point& time, TTask task ) {
+    Entry entry;
+    entry.id = id;
+    entry.tick = toTick( time );
+    entry.task = std::move( task );
+    insert( std::move( entry ) );
+}
+
+bool TimerWheel::remove( const TTimerId& id ) {
+    auto it = mLocations.find( id );
+    if ( it == mLocations.end() )
+        return false;
+    unlink( it->second );
+    mLocations.erase( it );
+    return true;
+}
+
+void TimerWheel::advance( const TClock::time_point& time, std::vector<TTimer>& expired ) {
+    if ( time < mStart )
+        return;
+    uint64_t target = (uint64_t)( ( time - mStart ) / mResolution );
+
+    while ( 1 ) {
+        uint64_t tick = getNextEventTick();
+        if ( tick > target )
+            break;
+        mCurrentTick = tick;
+
+        if ( !mOverflow.empty() ) {
+            TSlot entries;
+            entries.swap( mOverflow );
+            for( Entry& entry: entries )
+                insert( std::move( entry ) );
+        }
+
+        // Move down the timers of the slots starting now, from the top level
+        for( uint32_t level = cLevels - 1; level > 0; level-- ) {
+            uint32_t shift = cSlotBits * level;
+            if ( mCurrentTick & ( ( 1ULL << shift ) - 1 ) )
+                continue;
+            uint32_t index = ( mCurrentTick >> shift ) & ( cSlots - 1 );
+            if ( mOccupied[level] & ( 1ULL << index ) )
+                cascade( level, index );
+        }
+
+        // Expire the timers of the current tick
+        uint32_t index = mCurrentTick & ( cSlots - 1 );
+        TSlot& slot = mSlots[0][index];
+        for( Entry& entry: slot ) {
+            mLocations.erase( entry.id );
+            expired.emplace_back( entry.id, std::move( entry.task ) );
+        }
+        slot.clear();
+        mOccupied[0] &= ~( 1ULL << index );
+    }
+    mCurrentTick = std::max( mCurrentTick, target );
+}
+
+TimerWheel::TClock::time_point TimerWheel::getNextWakeup() const {
+    uint64_t tick = getNextEventTick();
+    if ( tick == cNoTick )
+        return TClock::time_point::max();
+    return mStart + mResolution * tick;
+}
+
+}
+}
@@ -15,6 +15,11 @@ limitations under the License.
 */
 
 #include <fstream>
+#include <cerrno>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <sys/stat.h>
 #if defined(_WIN32)
 #include <direct.h>   // _mkdir
@@ -116,6 +121,17 @@ bool makeDirs( const std::string& dir_path, mode_t mode ) {
 }
 
 
+std::string getISO8601Time( const std::chrono::system_clock::time_point& time ) {
+    std::time_t seconds = std::chrono::system_clock::to_time_t( time );
+    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>( time.time_since_epoch() ).count() % 1000;
+    std::tm tm_utc;
+    gmtime_r( &seconds, &tm_utc );
+    return fmt::format( "{:04d}-{:02d}-{:02d}T{:02d}:{:02d}:{:02d}.{:03d}Z",
+            tm_utc.tm_year + 1900, tm_utc.tm_mon + 1, tm_utc.tm_mday,
+            tm_utc.tm_hour, tm_utc.tm_min, tm_utc.tm_sec, (int)ms );
+}
+
+
 std::string typeToString( const Json::ValueType& type ) {
     std::string sType;
     switch( type ) {
@@ -205,6 +221,291 @@ Json::Value parseJsonFile( const std::string& file_path ) {
 }
 
 
+/*Single pass JSON scanner extracting the scalar values found at the requested key paths:
+ other values are validated and skipped without building any DOM node. Tested by
+ tests/json_extractor_tests.cpp*/
+class JsonValueExtractor {
+
+protected:
+    static const uint32_t cMaxDepth = 64;
+
+    const char* mCur;
+    const char* mEnd;
+    const std::vector<std::vector<std::string>>& mPaths;
+    Json::Value& mValues;
+    std::vector<std::string> mKeys;     ///< Key path of the value being parsed
+    std::string mString;
+
+    void skipSpaces() {
+        while ( ( mCur < mEnd ) && ( ( *mCur == ' ' ) || ( *mCur == '\t' ) || ( *mCur == '\n' ) || ( *mCur == '\r' ) ) )
+            mCur++;
+    }
+
+    bool consume( const char& c ) {
+        skipSpaces();
+        if ( ( mCur < mEnd ) && ( *mCur == c ) ) {
+            mCur++;
+            return true;
+        }
+        return false;
+    }
+
+    // 0: not on a requested path, 1: on the way to a requested value, 2: requested value
+    int matchPath() const {
+        int match = 0;
+        for( const auto& path: mPaths ) {
+            if ( ( path.size() < mKeys.size() ) || !std::equal( mKeys.begin(), mKeys.end(), path.begin() ) )
+                continue;
+            if ( path.size() == mKeys.size() )
+                return 2;
+            match = 1;
+        }
+        return match;
+    }
+
+    void store( const Json::Value& value ) {
+        Json::Value* node = &mValues;
+        for( const auto& key: mKeys )
+            node = &( *node )[key];
+        *node = value;
+    }
+
+    bool parseHex4( uint32_t& code ) {
+        if ( mEnd - mCur < 4 )
+            return false;
+        code = 0;
+        for( int i = 0; i < 4; i++ ) {
+            char c = *mCur++;
+            code <<= 4;
+            if ( ( c >= '0' ) && ( c <= '9' ) ) code |= (uint32_t)( c - '0' );
+            else if ( ( c >= 'a' ) && ( c <= 'f' ) ) code |= (uint32_t)( c - 'a' + 10 );
+            else if ( ( c >= 'A' ) && ( c <= 'F' ) ) code |= (uint32_t)( c - 'A' + 10 );
+            else return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8( std::string& out, const uint32_t& code ) {
+        if ( code < 0x80 ) {
+            out.push_back( (char)code );
+        } else if ( code < 0x800 ) {
+            out.push_back( (char)( 0xC0 | ( code >> 6 ) ) );
+            out.push_back( (char)( 0x80 | ( code & 0x3F ) ) );
+        } else if ( code < 0x10000 ) {
+            out.push_back( (char)( 0xE0 | ( code >> 12 ) ) );
+            out.push_back( (char)( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            out.push_back( (char)( 0x80 | ( code & 0x3F ) ) );
+        } else {
+            out.push_back( (char)( 0xF0 | ( code >> 18 ) ) );
+            out.push_back( (char)( 0x80 | ( ( code >> 12 ) & 0x3F ) ) );
+            out.push_back( (char)( 0x80 | ( ( code >> 6 ) & 0x3F ) ) );
+            out.push_back( (char)( 0x80 | ( code & 0x3F ) ) );
+        }
+    }
+
+    // Parse a string starting at the opening quote; the content is decoded only if out is not null
+    bool parseString( std::string* out ) {
+        mCur++;
+        if ( out )
+            out->clear();
+        while ( mCur < mEnd ) {
+            char c = *mCur++;
+            if ( c == '"' )
+                return true;
+            if ( (unsigned char)c < 0x20 )
+                return false;
+            if ( c != '\\' ) {
+                if ( out )
+                    out->push_back( c );
+                continue;
+            }
+            if ( mCur >= mEnd )
+                return false;
+            c = *mCur++;
+            switch( c ) {
+                case '"': case '\\': case '/': break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'u': {
+                    uint32_t code, low;
+                    if ( !parseHex4( code ) )
+                        return false;
+                    if ( ( code >= 0xD800 ) && ( code < 0xDC00 ) ) {
+                        // Surrogate pair
+                        if ( ( mEnd - mCur < 2 ) || ( mCur[0] != '\\' ) || ( mCur[1] != 'u' ) )
+                            return false;
+                        mCur += 2;
+                        if ( !parseHex4( low ) || ( low < 0xDC00 ) || ( low > 0xDFFF ) )
+                            return false;
+                        code = 0x10000 + ( ( code - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+                    } else if ( ( code >= 0xDC00 ) && ( code <= 0xDFFF ) ) {
+                        // Low surrogate without high surrogate
+                        return false;
+                    }
+                    if ( out )
+                        appendUtf8( *out, code );
+                    continue;
+                }
+                default: return false;
+            }
+            if ( out )
+                out->push_back( c );
+        }
+        return false;
+    }
+
+    // Skip a sequence of digits: return false if there is none
+    bool skipDigits() {
+        const char* start = mCur;
+        while ( ( mCur < mEnd ) && ( *mCur >= '0' ) && ( *mCur <= '9' ) )
+            mCur++;
+        return mCur != start;
+    }
+
+    // Parse a number with the JSON grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    bool parseNumber( const bool& keep ) {
+        const char* start = mCur;
+        bool is_integer = true;
+        if ( ( mCur < mEnd ) && ( *mCur == '-' ) )
+            mCur++;
+        if ( ( mCur < mEnd ) && ( *mCur == '0' ) )
+            mCur++;
+        else if ( !skipDigits() )
+            return false;
+        if ( ( mCur < mEnd ) && ( *mCur == '.' ) ) {
+            mCur++;
+            is_integer = false;
+            if ( !skipDigits() )
+                return false;
+        }
+        if ( ( mCur < mEnd ) && ( ( *mCur == 'e' ) || ( *mCur == 'E' ) ) ) {
+            mCur++;
+            is_integer = false;
+            if ( ( mCur < mEnd ) && ( ( *mCur == '+' ) || ( *mCur == '-' ) ) )
+                mCur++;
+            if ( !skipDigits() )
+                return false;
+        }
+        if ( !keep )
+            return true;
+        mString.assign( start, mCur );
+        // Integers out of the 64-bit range are kept as double, like the JSON reader does
+        errno = 0;
+        if ( is_integer && ( *start == '-' ) ) {
+            Json::Int64 value = std::strtoll( mString.c_str(), nullptr, 10 );
+            if ( errno != ERANGE ) {
+                store( Json::Value( value ) );
+                return true;
+            }
+        } else if ( is_integer ) {
+            Json::UInt64 value = std::strtoull( mString.c_str(), nullptr, 10 );
+            if ( errno != ERANGE ) {
+                store( Json::Value( value ) );
+                return true;
+            }
+        }
+        store( Json::Value( std::strtod( mString.c_str(), nullptr ) ) );
+        return true;
+    }
+
+    bool parseLiteral( const char* literal, const Json::Value& value, const bool& keep ) {
+        size_t len = strlen( literal );
+        if ( ( (size_t)( mEnd - mCur ) < len ) || ( strncmp( mCur, literal, len ) != 0 ) )
+            return false;
+        mCur += len;
+        if ( keep )
+            store( value );
+        return true;
+    }
+
+    bool parseObject( const uint32_t& depth, const int& match ) {
+        mCur++;
+        if ( consume( '}' ) )
+            return true;
+        do {
+            skipSpaces();
+            if ( ( mCur >= mEnd ) || ( *mCur != '"' ) )
+                return false;
+            int child_match = 0;
+            if ( match == 1 ) {
+                mKeys.emplace_back();
+                if ( !parseString( &mKeys.back() ) )
+                    return false;
+                child_match = matchPath();
+            } else if ( !parseString( nullptr ) ) {
+                return false;
+            }
+            if ( !consume( ':' ) || !parseValue( depth + 1, child_match ) )
+                return false;
+            if ( match == 1 )
+                mKeys.pop_back();
+        } while ( consume( ',' ) );
+        return consume( '}' );
+    }
+
+    bool parseArray( const uint32_t& depth ) {
+        mCur++;
+        if ( consume( ']' ) )
+            return true;
+        do {
+            if ( !parseValue( depth + 1, 0 ) )
+                return false;
+        } while ( consume( ',' ) );
+        return consume( ']' );
+    }
+
+    bool parseValue( const uint32_t& depth, const int& match ) {
+        skipSpaces();
+        if ( ( mCur >= mEnd ) || ( depth > cMaxDepth ) )
+            return false;
+        bool keep = ( match == 2 );
+        switch( *mCur ) {
+            // Only scalar values are extracted
+            case '{': return !keep && parseObject( depth, match );
+            case '[': return !keep && parseArray( depth );
+            case '"': {
+                if ( !parseString( keep ? &mString : nullptr ) )
+                    return false;
+                if ( keep )
+                    store( Json::Value( mString ) );
+                return true;
+            }
+            case 't': return parseLiteral( "true", Json::Value( true ), keep );
+            case 'f': return parseLiteral( "false", Json::Value( false ), keep );
+            case 'n': return parseLiteral( "null", Json::Value( Json::nullValue ), keep );
+            default: return parseNumber( keep );
+        }
+    }
+
+public:
+    JsonValueExtractor( const std::string& json_string, const std::vector<std::vector<std::string>>& paths,
+            Json::Value& values )
+        : mCur( json_string.c_str() ), mEnd( json_string.c_str() + json_string.size() ),
+          mPaths( paths ), mValues( values ) {}
+
+    bool run() {
+        if ( !parseValue( 0, 1 ) )
+            return false;
+        skipSpaces();
+        return mCur == mEnd;
+    }
+};
+
+
+/* Extract from a JSON document the scalar values found at the given key paths into a JSON object
+ with the same hierarchy. Missing paths are ignored. Return false if the document is malformed
+ or if a value found at a given path is an object or an array.*/
+bool extractJsonValues( const std::string& json_string, const std::vector<std::vector<std::string>>& paths,
+        Json::Value& values ) {
+    values = Json::objectValue;
+    JsonValueExtractor extractor( json_string, paths, values );
+    return extractor.run();
+}
+
+
 const Json::Value& JVgetRequired( const Json::Value& jval,
         const char* key,
         const Json::ValueType& type ) {
@@ -238,13 +539,15 @@ const Json::Value& JVgetOptional( const Json::Value& jval,
         Throw( DRM_BadFormat, "Wrong parameter type for '{}' = {}, expecting {}, parsed as {}",
                 key, jvalmember.toStyledString(), typeToString( type ), typeToString( jvalmember.type() ) );
 
-    std::string val = jvalmember.toStyledString();
-    val = val.erase( val.find_last_not_of("\t\n\v\f\r") + 1 );
+    if ( isLogEnabled( spdlog::level::debug ) ) {
+        std::string val = jvalmember.toStyledString();
+        val = val.erase( val.find_last_not_of("\t\n\v\f\r") + 1 );
 
-    if ( exists )
-        Debug( "Found parameter '{}' of type {} with value {}", key, typeToString( jvalmember.type() ), val );
-    else
-        Debug( "Set parameter '{}' of type {} to default value {}", key, typeToString( jvalmember.type() ), val );
+        if ( exists )
+            Debug( "Found parameter '{}' of type {} with value {}", key, typeToString( jvalmember.type() ), val );
+        else
+            Debug( "Set parameter '{}' of type {} to default value {}", key, typeToString( jvalmember.type() ), val );
+    }
 
     return jvalmember;
 }
@@ -0,0 +1,68 @@
+/*
+Copyright (C) 2018, Accelize
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "log.h"
+#include "worker_pool.h"
+
+namespace Accelize {
+namespace DRM {
+
+
+WorkerPool::WorkerPool( const size_t& num_workers, const ThreadSettings& settings ) {
+    for( size_t i = 0; i < num_workers; i++ )
+        mWorkers.push_back( startThread( settings, "drm_worker", [ this ]() { run(); } ) );
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mStopRequest = true;
+    }
+    mCondVar.notify_all();
+    for( std::future<void>& worker: mWorkers )
+        worker.get();
+}
+
+void WorkerPool::run() {
+    while ( 1 ) {
+        TTask task;
+        {
+            std::unique_lock<std::mutex> lock( mMutex );
+            mCondVar.wait( lock, [ this ]{ return mStopRequest || !mQueue.empty(); } );
+            // Tasks still queued are not lost
+            if ( mQueue.empty() )
+                break;
+            task = std::move( mQueue.front() );
+            mQueue.pop_front();
+        }
+        try {
+            task();
+        } catch( const std::exception& e ) {
+            Error( "Worker task failed: {}", e.what() );
+        }
+    }
+}
+
+void WorkerPool::submit( TTask task ) {
+    {
+        std::lock_guard<std::mutex> lock( mMutex );
+        mQueue.push_back( std::move( task ) );
+    }
+    mCondVar.notify_one();
+}
+
+}
+}
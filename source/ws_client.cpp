@@ -20,6 +20,13 @@ limitations under the License.
 #include <chrono>
 #include <unistd.h>
 #include <math.h>
+#include <cmath>
+#include <strings.h>
+#include <algorithm>
+#include <fcntl.h>
+#include <thread>
+#include <sys/file.h>
+#include <sys/stat.h>
 
 #include "log.h"
 #include "utils.h"
@@ -40,19 +47,63 @@ CurlEasyPost::~CurlEasyPost() {
     curl_easy_cleanup( curl );
 }
 
+// Upper limit of the response buffer reserved from the Content-Length header
+static const size_t cMaxResponseReserve = 1024 * 1024;
+
+// Result of the last request of each thread: clients shared by several DRM managers run
+// their requests concurrently
+static thread_local long tRetryAfter = 0;
+static thread_local long tResponseCode = 0;
+static thread_local std::string tResponseBuffer;   // Reused between license requests to keep its capacity
+
+size_t CurlEasyPost::header_callback( char *buffer, size_t size, size_t nitems, void *userp ) {
+    auto *self = (CurlEasyPost*)userp;
+    size_t realsize = size * nitems;
+    static const char content_length[] = "content-length:";
+    const size_t length_len = sizeof( content_length ) - 1;
+    if ( self->mResponse && ( realsize > length_len ) && ( strncasecmp( buffer, content_length, length_len ) == 0 ) ) {
+        // Pre-allocate the response buffer
+        size_t length = strtoul( buffer + length_len, nullptr, 10 );
+        self->mResponse->reserve( self->mResponse->size() + std::min( length, cMaxResponseReserve ) );
+        return realsize;
+    }
+    static const char retry_after[] = "retry-after:";
+    const size_t key_len = sizeof( retry_after ) - 1;
+    if ( ( realsize > key_len ) && ( strncasecmp( buffer, retry_after, key_len ) == 0 ) ) {
+        std::string value( buffer + key_len, realsize - key_len );
+        value.erase( 0, value.find_first_not_of( " \t" ) );
+        value.erase( value.find_last_not_of( " \t\r\n" ) + 1 );
+        if ( !value.empty() && ( value.find_first_not_of( "0123456789" ) == std::string::npos ) ) {
+            // Delay in seconds
+            self->mRetryAfter = std::stol( value );
+        } else {
+            // HTTP date
+            time_t date = curl_getdate( value.c_str(), nullptr );
+            if ( date > 0 )
+                self->mRetryAfter = std::max( (long)( date - time( nullptr ) ), 0L );
+        }
+    }
+    return realsize;
+}
+
 long CurlEasyPost::perform( std::string* resp, std::chrono::steady_clock::time_point deadline ) {
     CURLcode res;
     long resp_code;
 
+    mRetryAfter = 0;
+    mResponse = resp;
+
     if ( headers ) {
         curl_easy_setopt( curl, CURLOPT_HTTPHEADER, headers );
         std::string sHeader;
-        for( const std::string& h: data )
+        for( const std::string& h: header_data )
             sHeader += std::string("\t") + h + std::string("\n");
         Debug2( "CURL header:\n{}", sHeader );
     }
     curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, &CurlEasyPost::write_callback );
     curl_easy_setopt( curl, CURLOPT_WRITEDATA, (void*)resp );
+    curl_easy_setopt( curl, CURLOPT_HEADERFUNCTION, &CurlEasyPost::header_callback );
+    curl_easy_setopt( curl, CURLOPT_HEADERDATA, (void*)this );
     curl_easy_setopt( curl, CURLOPT_ERRORBUFFER, errbuff.data() );
     curl_easy_setopt( curl, CURLOPT_FOLLOWLOCATION, 1L );
 
@@ -64,6 +115,7 @@ long CurlEasyPost::perform( std::string* resp, std::chrono::steady_clock::time_p
     }
 
     res = curl_easy_perform( curl );
+    mResponse = nullptr;
     if ( res != CURLE_OK ) {
         if ( res == CURLE_COULDNT_RESOLVE_PROXY
           || res == CURLE_COULDNT_RESOLVE_HOST
@@ -87,42 +139,255 @@ double CurlEasyPost::getTotalTime() {
     Unreachable( "Failed to get the CURLINFO_TOTAL_TIME information" ); //LCOV_EXCL_LINE
 }
 
+CurlTimings CurlEasyPost::getTimings() {
+    double namelookup = 0, connect = 0, appconnect = 0, starttransfer = 0, total = 0;
+    CurlTimings timings;
+    curl_easy_getinfo( curl, CURLINFO_NAMELOOKUP_TIME, &namelookup );
+    curl_easy_getinfo( curl, CURLINFO_CONNECT_TIME, &connect );
+    curl_easy_getinfo( curl, CURLINFO_APPCONNECT_TIME, &appconnect );
+    curl_easy_getinfo( curl, CURLINFO_STARTTRANSFER_TIME, &starttransfer );
+    curl_easy_getinfo( curl, CURLINFO_TOTAL_TIME, &total );
+    // Curl times are cumulative from the start of the request: a reused connection has no connect nor TLS time
+    double connected = std::max( std::max( connect, appconnect ), namelookup );
+    timings.dns = namelookup;
+    timings.connect = std::max( connect - namelookup, 0.0 );
+    timings.tls = ( appconnect > 0 ) ? std::max( appconnect - connect, 0.0 ) : 0.0;
+    timings.ttfb = std::max( starttransfer - connected, 0.0 );
+    timings.transfer = std::max( total - starttransfer, 0.0 );
+    timings.total = total;
+    return timings;
+}
 
 
-DrmWSClient::DrmWSClient( const std::string &conf_file_path, const std::string &cred_file_path ) {
+WSRequestStatistics::WSRequestStatistics():
+        mDnsTime( Histogram::exponentialBounds( 5 ) ),
+        mConnectTime( Histogram::exponentialBounds( 5 ) ),
+        mTlsTime( Histogram::exponentialBounds( 5 ) ),
+        mTtfbTime( Histogram::exponentialBounds( 5 ) ),
+        mTransferTime( Histogram::exponentialBounds( 5 ) ),
+        mTotalTime( Histogram::exponentialBounds( 5 ) ) {}
+
+void WSRequestStatistics::recordResponse( const long& resp_code, const CurlTimings& timings ) {
+    // Histograms are in milliseconds
+    mDnsTime.record( (uint64_t)std::round( timings.dns * 1000 ) );
+    mConnectTime.record( (uint64_t)std::round( timings.connect * 1000 ) );
+    mTlsTime.record( (uint64_t)std::round( timings.tls * 1000 ) );
+    mTtfbTime.record( (uint64_t)std::round( timings.ttfb * 1000 ) );
+    mTransferTime.record( (uint64_t)std::round( timings.transfer * 1000 ) );
+    mTotalTime.record( (uint64_t)std::round( timings.total * 1000 ) );
+    std::lock_guard<std::mutex> lock( mMutex );
+    mResponseCodes[ std::to_string( resp_code ) ] ++;
+}
 
-    mOAuth2Token = std::string("");
-    mTokenValidityPeriod = 0;
-    mTokenExpirationTime = TClock::now();
+void WSRequestStatistics::recordRetryableError( const std::string& reason ) {
+    std::lock_guard<std::mutex> lock( mMutex );
+    mRetryableErrors[ reason ] ++;
+}
 
-    try {
-        Json::Value conf_json = parseJsonFile( conf_file_path );
-        Json::Value webservice_json = JVgetRequired( conf_json, "licensing", Json::objectValue );
-        Debug2( "Web service configuration: {}", webservice_json.toStyledString() );
+std::map<std::string, uint64_t> WSRequestStatistics::getResponseCodes() const {
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mResponseCodes;
+}
 
-        std::string url = JVgetRequired( webservice_json, "url", Json::stringValue ).asString();
-        mOAuth2Url = url + std::string("/o/token/");
-        mMeteringUrl = url + std::string("/auth/metering/genlicense/");
-        Debug( "Licensing URL: {}", url );
+std::map<std::string, uint64_t> WSRequestStatistics::getRetryableErrors() const {
+    std::lock_guard<std::mutex> lock( mMutex );
+    return mRetryableErrors;
+}
 
-    } catch( Exception &e ) {
-        Throw( e.getErrCode(), "Error with service configuration file '{}': {}",
-                conf_file_path, e.what() );
+std::vector<std::pair<std::string, const Histogram*>> WSRequestStatistics::getPhaseTimes() const {
+    return { { "dns", &mDnsTime }, { "connect", &mConnectTime }, { "tls", &mTlsTime },
+             { "ttfb", &mTtfbTime }, { "transfer", &mTransferTime }, { "total", &mTotalTime } };
+}
+
+Json::Value WSRequestStatistics::toJson() const {
+    Json::Value node;
+    node["dns_time_ms"] = mDnsTime.toJson();
+    node["connect_time_ms"] = mConnectTime.toJson();
+    node["tls_time_ms"] = mTlsTime.toJson();
+    node["ttfb_time_ms"] = mTtfbTime.toJson();
+    node["transfer_time_ms"] = mTransferTime.toJson();
+    node["total_time_ms"] = mTotalTime.toJson();
+    std::lock_guard<std::mutex> lock( mMutex );
+    node["response_codes"] = Json::objectValue;
+    for( const auto& it: mResponseCodes )
+        node["response_codes"][it.first] = (Json::UInt64)it.second;
+    node["retries"] = Json::objectValue;
+    for( const auto& it: mRetryableErrors )
+        node["retries"][it.first] = (Json::UInt64)it.second;
+    return node;
+}
+
+
+
+// Output stream buffer appending to a string: serializing into a cleared string reuses its capacity
+class StringAppendBuffer: public std::streambuf {
+protected:
+    std::string& mString;
+
+    int_type overflow( int_type c ) override {
+        if ( c != traits_type::eof() )
+            mString.push_back( (char)c );
+        return c;
+    }
+
+    std::streamsize xsputn( const char* s, std::streamsize n ) override {
+        mString.append( s, (size_t)n );
+        return n;
     }
 
+public:
+    explicit StringAppendBuffer( std::string& str ): mString( str ) {}
+};
+
+
+// FNV-1a 64-bit hash: stable between processes and library builds, unlike std::hash
+static uint64_t fnv1aHash( const std::string& str ) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for( const char& c: str ) {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+TokenCache::TokenCache( const std::string& dir_path, const std::string& client_id, const std::string& url ) {
+    if ( !makeDirs( dir_path, S_IRWXU ) )
+        Throw( DRM_ExternFail, "Failed to create token cache directory {}", dir_path );
+    std::string key_hash = fmt::format( "{:016x}", fnv1aHash( client_id + '\n' + url ) );
+    mFilePath = dir_path + "/token_" + key_hash + ".json";
+    mLockFilePath = mFilePath + ".lock";
+    Debug( "Token cache file: {}", mFilePath );
+}
+
+TokenCache::~TokenCache() {
+    unlock();
+}
+
+bool TokenCache::lock( std::chrono::steady_clock::time_point deadline ) {
+    if ( mLockFd >= 0 )
+        return true;
+    mLockFd = open( mLockFilePath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR );
+    if ( mLockFd < 0 ) {
+        Warning( "Failed to open token cache lock file {}: {}", mLockFilePath, strerror( errno ) );
+        return false;
+    }
+    while ( flock( mLockFd, LOCK_EX | LOCK_NB ) != 0 ) {
+        if ( ( errno != EWOULDBLOCK ) || ( std::chrono::steady_clock::now() >= deadline ) ) {
+            Debug( "Could not lock token cache before deadline: requesting a token without cache synchronization" );
+            close( mLockFd );
+            mLockFd = -1;
+            return false;
+        }
+        std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    }
+    return true;
+}
+
+void TokenCache::unlock() {
+    if ( mLockFd < 0 )
+        return;
+    flock( mLockFd, LOCK_UN );
+    close( mLockFd );
+    mLockFd = -1;
+}
+
+bool TokenCache::load( std::string& token, uint32_t& validity,
+        std::chrono::system_clock::time_point& expiration ) const {
+    // Only trust a file owned by the current user and not accessible by others
+    struct stat info;
+    if ( stat( mFilePath.c_str(), &info ) != 0 )
+        return false;
+    if ( ( info.st_uid != getuid() ) || ( info.st_mode & ( S_IRWXG | S_IRWXO ) ) ) {
+        Warning( "Ignoring token cache file {} because of unsafe ownership or permissions", mFilePath );
+        return false;
+    }
     try {
-        Json::Value cred_json = parseJsonFile( cred_file_path );
-        Json::Value client_id_json = JVgetRequired( cred_json, "client_id", Json::stringValue );
-        mClientId = client_id_json.asString();
-        Json::Value client_secret_json = JVgetRequired( cred_json, "client_secret", Json::stringValue );
-        mClientSecret = client_secret_json.asString();
-    } catch( Exception &e ) {
-        Throw( e.getErrCode(), "Error with credential file '{}': {}", cred_file_path, e.what() );
+        Json::Value cache_json = parseJsonFile( mFilePath );
+        token = JVgetRequired( cache_json, "access_token", Json::stringValue ).asString();
+        validity = JVgetRequired( cache_json, "expires_in", Json::uintValue ).asUInt();
+        int64_t expiration_s = JVgetRequired( cache_json, "expiration", Json::intValue ).asInt64();
+        expiration = std::chrono::system_clock::time_point( std::chrono::seconds( expiration_s ) );
+    } catch( const Exception& e ) {
+        Debug( "Ignoring invalid token cache file {}: {}", mFilePath, e.what() );
+        return false;
+    }
+    return true;
+}
+
+void TokenCache::save( const std::string& token, const uint32_t& validity,
+        const std::chrono::system_clock::time_point& expiration ) const {
+    Json::Value cache_json;
+    cache_json["access_token"] = token;
+    cache_json["expires_in"] = validity;
+    cache_json["expiration"] = (Json::Int64)std::chrono::duration_cast<std::chrono::seconds>(
+            expiration.time_since_epoch() ).count();
+    std::string content = saveJsonToString( cache_json );
+
+    // Write a private temporary file then rename it so that readers never see a partial token
+    std::string tmp_path = fmt::format( "{}.{}.tmp", mFilePath, getpid() );
+    int fd = open( tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR );
+    if ( fd < 0 ) {
+        Warning( "Failed to create token cache file {}: {}", tmp_path, strerror( errno ) );
+        return;
+    }
+    bool ok = ( write( fd, content.c_str(), content.size() ) == (ssize_t)content.size() )
+            && ( fsync( fd ) == 0 );
+    close( fd );
+    if ( !ok || ( rename( tmp_path.c_str(), mFilePath.c_str() ) != 0 ) ) {
+        Warning( "Failed to update token cache file {}: {}", mFilePath, strerror( errno ) );
+        unlink( tmp_path.c_str() );
+        return;
+    }
+    Debug( "Saved authentication token in cache file {}", mFilePath );
+}
+
+void TokenCache::remove( const std::string& token, std::chrono::steady_clock::time_point deadline ) {
+    // Another process may have replaced the rejected token meanwhile: keep its token
+    bool locked = lock( deadline );
+    std::string cached_token;
+    uint32_t validity;
+    std::chrono::system_clock::time_point expiration;
+    if ( load( cached_token, validity, expiration ) && ( cached_token == token ) ) {
+        if ( unlink( mFilePath.c_str() ) == 0 )
+            Debug( "Removed token cache file {}", mFilePath );
     }
+    if ( locked )
+        unlock();
+}
+
+
+// Time before its expiration when a token is no longer used: a tenth of its validity, at most 30 seconds
+static std::chrono::seconds getTokenExpirationMargin( const uint32_t& validity ) {
+    return std::chrono::seconds( std::min( validity / 10, (uint32_t)30 ) );
+}
+
+
+
+DrmWSClient::DrmWSClient( const DrmConfig& config ) {
+
+    mOAuth2Token = std::string("");
+    mTokenValidityPeriod = 0;
+    mTokenExpirationTime = TClock::now();
+
+    const WebServiceConfig& web_service = config.getWebService();
+    mOAuth2Url = web_service.url + std::string("/o/token/");
+    mMeteringUrl = web_service.url + std::string("/auth/metering/genlicense/");
+    mClientId = web_service.client_id;
+    mClientSecret = web_service.client_secret;
+
+    if ( !web_service.token_cache_dir.empty() )
+        mTokenCache.reset( new TokenCache( web_service.token_cache_dir, mClientId, web_service.url ) );
 
     CurlSingleton::Init();
 
     // Set headers of OAuth2 request
+    Json::StreamWriterBuilder builder;
+    builder["indentation"] = "";
+    mJsonWriter.reset( builder.newStreamWriter() );
+
+    mOAuth2Statistics = std::make_shared<WSRequestStatistics>();
+    mLicenseStatistics = std::make_shared<WSRequestStatistics>();
+
     mOAUth2Request.setURL( mOAuth2Url );
     std::stringstream ss;
     ss << "client_id=" << mClientId << "&client_secret=" << mClientSecret;
@@ -130,33 +395,129 @@ DrmWSClient::DrmWSClient( const std::string &conf_file_path, const std::string &
     mOAUth2Request.setPostFields( ss.str() );
 }
 
+long DrmWSClient::getRetryAfter() const {
+    return tRetryAfter;
+}
+
+long DrmWSClient::getResponseCode() const {
+    return tResponseCode;
+}
+
 uint32_t DrmWSClient::getTokenTimeLeft() const {
+    std::lock_guard<std::recursive_mutex> lock( mMutex );
     TClock::duration delta = mTokenExpirationTime - TClock::now();
     return (uint32_t)round( (double)delta.count() / 1000000000 );
 }
 
 void DrmWSClient::setOAuth2token( const std::string& token ) {
+    std::lock_guard<std::recursive_mutex> lock( mMutex );
     mOAuth2Token = token;
     mTokenValidityPeriod = 10;
     mTokenExpirationTime = TClock::now() + std::chrono::seconds( mTokenValidityPeriod );
+    mTokenFromCache = false;
+}
+
+bool DrmWSClient::loadOAuth2tokenFromCache() {
+    std::string token;
+    uint32_t validity;
+    std::chrono::system_clock::time_point expiration;
+
+    if ( !mTokenCache->load( token, validity, expiration ) )
+        return false;
+    auto time_left = expiration - std::chrono::system_clock::now();
+    if ( time_left <= getTokenExpirationMargin( validity ) ) {
+        Debug( "Cached authentication token has expired or is about to expire" );
+        return false;
+    }
+    mOAuth2Token = token;
+    mTokenValidityPeriod = validity;
+    mTokenExpirationTime = TClock::now() + std::chrono::duration_cast<TClock::duration>( time_left );
+    mTokenFromCache = true;
+    Debug( "Reusing authentication token from cache, valid for {} seconds", getTokenTimeLeft() );
+    return true;
 }
 
 void DrmWSClient::requestOAuth2token( TClock::time_point deadline ) {
 
+    std::lock_guard<std::recursive_mutex> lock( mMutex );
+
     // Check if a token exists
     if ( !mOAuth2Token.empty() ) {
         // Check if existing token has expired or is about to expire
-        if ( mTokenExpirationTime > TClock::now() ) {
+        if ( mTokenExpirationTime - getTokenExpirationMargin( mTokenValidityPeriod ) > TClock::now() ) {
             Debug( "Current authentication token is still valid" );
             return;
         }
         Debug( "Current authentication token has expired" );
     }
 
+    if ( !mTokenCache ) {
+        requestOAuth2tokenFromWS( deadline );
+        return;
+    }
+
+    // Only one process refreshes the token: the others wait and reuse it
+    mTokenCache->lock( deadline );
+    try {
+        if ( !loadOAuth2tokenFromCache() ) {
+            requestOAuth2tokenFromWS( deadline );
+            mTokenCache->save( mOAuth2Token, mTokenValidityPeriod, std::chrono::system_clock::now()
+                    + std::chrono::duration_cast<std::chrono::system_clock::duration>( mTokenExpirationTime - TClock::now() ) );
+        }
+    } catch( ... ) {
+        mTokenCache->unlock();
+        throw;
+    }
+    mTokenCache->unlock();
+}
+
+long DrmWSClient::performRequest( CurlEasyPost& req, std::string& response, TClock::time_point deadline,
+        WSRequestStatistics& statistics, const std::string& ws_name ) {
+    long resp_code;
+    tRetryAfter = 0;
+    tResponseCode = 0;
+    try {
+        resp_code = req.perform( &response, deadline );
+    } catch( const Exception& e ) {
+        if ( e.getErrCode() == DRM_WSMayRetry )
+            statistics.recordRetryableError( "network" );
+        if ( mEventLog ) {
+            Json::Value fields;
+            fields["ws"] = ws_name;
+            fields["outcome"] = "network_error";
+            fields["error"] = e.what();
+            mEventLog->write( "ws_attempt", fields );
+        }
+        throw;
+    }
+    tRetryAfter = req.getRetryAfter();
+    tResponseCode = resp_code;
+    CurlTimings timings = req.getTimings();
+    statistics.recordResponse( resp_code, timings );
+    bool is_retryable = CurlEasyPost::is_error_retryable( resp_code );
+    if ( is_retryable )
+        statistics.recordRetryableError( std::to_string( resp_code ) );
+    if ( mEventLog ) {
+        Json::Value fields;
+        fields["ws"] = ws_name;
+        fields["http_code"] = (Json::Int64)resp_code;
+        fields["outcome"] = ( resp_code == 200 ) ? "success" : ( is_retryable ? "retryable_error" : "error" );
+        fields["latency_ms"] = timings.total * 1000;
+        mEventLog->write( "ws_attempt", fields );
+    }
+    Debug( "Received code {} from {} Web Service in {} ms", resp_code, ws_name, timings.total * 1000 );
+    Debug2( "{} Web Service request timings: DNS={} ms, connect={} ms, TLS={} ms, TTFB={} ms, transfer={} ms",
+            ws_name, timings.dns * 1000, timings.connect * 1000, timings.tls * 1000,
+            timings.ttfb * 1000, timings.transfer * 1000 );
+    return resp_code;
+}
+
+void DrmWSClient::requestOAuth2tokenFromWS( TClock::time_point deadline ) {
+
     // Request a new token and wait response
     Debug( "Requesting a new authentication token from {}", mOAuth2Url );
     std::string response;
-    long resp_code = mOAUth2Request.perform( &response, deadline );
+    long resp_code = performRequest( mOAUth2Request, response, deadline, *mOAuth2Statistics, "OAuth2" );
 
     // Parse response
     std::string error_msg;
@@ -167,8 +528,6 @@ void DrmWSClient::requestOAuth2token( TClock::time_point deadline ) {
         json_resp = Json::nullValue;
         error_msg = e.what();
     }
-    Debug( "Received code {} from OAuth2 Web Service in {} ms",
-            resp_code, mOAUth2Request.getTotalTime() * 1000 );
 
     // Analyze response
     if ( resp_code != 200 ) {
@@ -191,37 +550,111 @@ void DrmWSClient::requestOAuth2token( TClock::time_point deadline ) {
     mOAuth2Token = JVgetRequired( json_resp, "access_token", Json::stringValue ).asString();
     mTokenValidityPeriod = JVgetRequired( json_resp, "expires_in", Json::intValue ).asInt();
     mTokenExpirationTime = TClock::now() + std::chrono::seconds( mTokenValidityPeriod );
+    mTokenFromCache = false;
 }
 
 
-Json::Value DrmWSClient::requestLicense( const Json::Value& json_req, TClock::time_point deadline ) {
+std::unique_ptr<CurlEasyPost> DrmWSClient::acquireLicenseHandle( const std::string& token ) {
+    std::unique_ptr<CurlEasyPost> req;
+    std::string req_token;
+    {
+        std::lock_guard<std::mutex> lock( mLicenseCacheMutex );
+        if ( !mLicenseHandles.empty() ) {
+            req = std::move( mLicenseHandles.back().first );
+            req_token = std::move( mLicenseHandles.back().second );
+            mLicenseHandles.pop_back();
+        }
+    }
+    if ( !req ) {
+        req.reset( new CurlEasyPost );
+        req->setURL( mMeteringUrl );
+    }
+    // Headers are built again only when the token changed
+    if ( req_token.empty() || ( req_token != token ) ) {
+        req->clearHeaders();
+        req->appendHeader( "Accept: application/json" );
+        req->appendHeader( "Content-Type: application/json" );
+        req->appendHeader( std::string("Authorization: Bearer ") + token );
+    }
+    return req;
+}
 
-    // Create new request
-    CurlEasyPost req;
-    req.setURL( mMeteringUrl );
-    req.appendHeader( "Accept: application/json" );
-    req.appendHeader( "Content-Type: application/json" );
-    req.appendHeader( std::string("Authorization: Bearer ") + mOAuth2Token );
-    req.setPostFields( saveJsonToString( json_req ) );
+void DrmWSClient::releaseLicenseHandle( std::unique_ptr<CurlEasyPost> req, const std::string& token ) {
+    std::lock_guard<std::mutex> lock( mLicenseCacheMutex );
+    mLicenseHandles.emplace_back( std::move( req ), token );
+}
 
-    // Send request and wait response
-    Debug( "Starting license request to {} with request:\n{}", mMeteringUrl, json_req.toStyledString() );
-    std::string response;
-    long resp_code = req.perform( &response, deadline );
+const std::vector<std::vector<std::string>>& DrmWSClient::getLicensePaths( const std::string& dna ) {
+    std::lock_guard<std::mutex> lock( mLicenseCacheMutex );
+    auto it = mLicensePaths.find( dna );
+    if ( it == mLicensePaths.end() ) {
+        std::vector<std::vector<std::string>> paths = {
+                { "metering", "sessionId" }, { "metering", "timeoutSecond" },
+                { "license", dna, "key" }, { "license", dna, "licenseTimer" } };
+        it = mLicensePaths.emplace( dna, std::move( paths ) ).first;
+    }
+    // Entries are never removed: the reference stays valid
+    return it->second;
+}
 
-    // Parse response
-    std::string error_msg;
-    Json::Value json_resp;
+Json::Value DrmWSClient::requestLicense( const Json::Value& json_req, TClock::time_point deadline, bool full_response ) {
+
+    std::lock_guard<std::recursive_mutex> lock( mMutex );
+
+    // Serialize the request into the reused buffer
+    mRequestBuffer.clear();
+    {
+        StringAppendBuffer buffer( mRequestBuffer );
+        std::ostream os( &buffer );
+        mJsonWriter->write( json_req, &os );
+    }
+    return requestLicense( mRequestBuffer, json_req.get( "dna", "" ).asString(), deadline, full_response );
+}
+
+
+Json::Value DrmWSClient::requestLicense( const std::string& request_body, const std::string& dna,
+        TClock::time_point deadline, bool full_response ) {
+
+    // Authenticate again if the previous token has been dropped
+    std::string token;
+    bool token_from_cache;
+    {
+        std::lock_guard<std::recursive_mutex> lock( mMutex );
+        if ( mOAuth2Token.empty() )
+            requestOAuth2token( deadline );
+        token = mOAuth2Token;
+        token_from_cache = mTokenFromCache;
+    }
+
+    // Reuse an idle request and its connection
+    std::unique_ptr<CurlEasyPost> req = acquireLicenseHandle( token );
+    req->setPostBuffer( request_body );
+
+    // Send request and wait response
+    Debug( "Starting license request to {} with request: {}", mMeteringUrl, request_body );
+    std::string& response = tResponseBuffer;
+    response.clear();
+    long resp_code;
     try {
-        json_resp = parseJsonString( response );
-    } catch ( const Exception& e ) {
-        json_resp = Json::nullValue;
-        error_msg = e.what();
+        resp_code = performRequest( *req, response, deadline, *mLicenseStatistics, "License" );
+    } catch( ... ) {
+        releaseLicenseHandle( std::move( req ), token );
+        throw;
     }
-    Debug( "Received code {} from License Web Service in {}ms",
-            resp_code, req.getTotalTime() * 1000 );
+    releaseLicenseHandle( std::move( req ), token );
 
     // Analyze response
+    if ( ( resp_code == 401 ) && token_from_cache ) {
+        // The cached token has been revoked: drop it, unless another request already did,
+        // and authenticate again on next attempt
+        std::lock_guard<std::recursive_mutex> lock( mMutex );
+        if ( mOAuth2Token == token ) {
+            mTokenCache->remove( token, deadline );
+            mOAuth2Token.clear();
+            mTokenFromCache = false;
+        }
+        Throw( DRM_WSMayRetry, "License Web Service rejected the cached authentication token: {}", response );
+    }
     if ( resp_code != 200 ) {
         // An error occurred
         DRM_ErrorCode drm_error;
@@ -233,10 +666,21 @@ Json::Value DrmWSClient::requestLicense( const Json::Value& json_req, TClock::ti
             drm_error = DRM_WSError;
         Throw( drm_error, "License Web Service error {}: {}", resp_code, response );
     }
-    // Verify response parsing
-    if ( json_resp == Json::nullValue )
+
+    // Extract only the fields used to install the license unless the full response is needed
+    Json::Value json_resp;
+    if ( !full_response ) {
+        if ( extractJsonValues( response, getLicensePaths( dna ), json_resp ) )
+            return json_resp;
+    }
+
+    // Parse the whole response: also reports the reason of a malformed response
+    try {
+        json_resp = parseJsonString( response );
+    } catch ( const Exception& e ) {
         Throw( DRM_WSRespError, "Failed to parse response from License Web Service because {}: {}",
-               error_msg, response);
+               e.what(), response);
+    }
 
     // No error: return the response as JSON object
     return json_resp;
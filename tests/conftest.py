@@ -769,6 +769,19 @@ class WSAdmin:
         return self._functions
 
 
+@pytest.fixture
+def ws_mock(pytestconfig):
+    """
+    Start a local mock of the License Web Service forwarding license requests to the
+    selected server.
+    """
+    from tests.ws_mock import MockWebService
+    server = pytestconfig.getoption("server")
+    mock = MockWebService(upstream=_LICENSING_SERVERS.get(server.lower(), server)).start()
+    yield mock
+    mock.stop()
+
+
 @pytest.fixture
 def ws_admin(cred_json, conf_json):
     cred_json.set_user('admin')
@@ -781,7 +794,7 @@ class ExecFunction:
     """
     Provide test functions using directly C or C++ object
     """
-    def __init__(self, slot_id, is_cpp, test_file_name, conf_path, cred_path):
+    def __init__(self, slot_id, is_cpp, test_file_name, conf_path, cred_path, second_slot_id=None):
         self._conf_path = conf_path
         self._cred_path = cred_path
         self._is_cpp = is_cpp
@@ -791,6 +804,8 @@ class ExecFunction:
             raise IOError("No executable '%s' found" % self._test_func_path)
         self._cmd_line = '%s -s %d -f %s -d %s' % (self._test_func_path, self._slot_id,
                                                    self._conf_path, self._cred_path)
+        if second_slot_id is not None:
+            self._cmd_line += ' -S %d' % second_slot_id
         if not self._is_cpp:
             self._cmd_line += ' -c'
         self.returncode = None
@@ -828,10 +843,10 @@ class ExecFunctionFactory:
         self._is_cpp = is_cpp
         self._is_release_build = is_release_build
 
-    def load(self, test_file_name, slot_id):
+    def load(self, test_file_name, slot_id, second_slot_id=None):
         try:
             return ExecFunction(slot_id, self._is_cpp, test_file_name, self._conf_path,
-                                self._cred_path)
+                                self._cred_path, second_slot_id)
         except IOError:
             if self._is_release_build:
                 pytest.skip("No executable '%s' found: test skipped" % self._test_func_path)
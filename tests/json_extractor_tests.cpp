@@ -0,0 +1,182 @@
+/*  Tests of the JSON scanner extracting the license response fields: documents are given inline. */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <json/json.h>
+
+#include "utils.h"
+
+using namespace std;
+using namespace Accelize::DRM;
+
+typedef vector<vector<string>> TPaths;
+
+
+#define CHECK_VALUE(val, exp_val) if ((val) != (exp_val)) { \
+    cout << __FUNCTION__ << ", " << __LINE__ << " - ERROR - bad value: got " << (val) << " but expect " << (exp_val) << endl; \
+    return -1; }
+
+#define CHECK_MALFORMED(doc, paths) { Json::Value values; \
+    if ( extractJsonValues( doc, paths, values ) ) { \
+        cout << __FUNCTION__ << ", " << __LINE__ << " - ERROR - accepted malformed document: " << (doc) << endl; \
+        return -1; } }
+
+
+static const TPaths sLicensePaths = {
+        { "metering", "sessionId" }, { "metering", "timeoutSecond" },
+        { "license", "DNA", "key" }, { "license", "DNA", "licenseTimer" } };
+
+
+// Values are extracted at their path with their type, the other values are skipped
+int test_extract() {
+    string doc = "{\"metering\": {\"sessionId\": \"ABC\", \"timeoutSecond\": 30, \"samples\": [1, [2, {\"a\": 3}], \"x\"]},"
+                 " \"license\": {\"OTHER\": {\"key\": \"wrong\"}, \"DNA\": {\"key\": \"0123\", \"licenseTimer\": \"4567\"}},"
+                 " \"extra\": {\"deep\": {\"deeper\": [true, false, null, -1.5e3]}}}";
+    Json::Value values;
+    CHECK_VALUE( extractJsonValues( doc, sLicensePaths, values ), true )
+    CHECK_VALUE( values["metering"]["sessionId"].asString(), "ABC" )
+    CHECK_VALUE( values["metering"]["timeoutSecond"].asUInt(), 30u )
+    CHECK_VALUE( values["license"]["DNA"]["key"].asString(), "0123" )
+    CHECK_VALUE( values["license"]["DNA"]["licenseTimer"].asString(), "4567" )
+    CHECK_VALUE( values["metering"].size(), 2u )
+    CHECK_VALUE( values["license"].size(), 1u )
+    CHECK_VALUE( values.isMember( "extra" ), false )
+
+    // Scalar types
+    doc = "{\"i\": -42, \"u\": 18446744073709551615, \"big\": 123456789012345678901234, \"d\": 0.25,"
+          " \"e\": 1E-2, \"z\": -0, \"t\": true, \"f\": false, \"n\": null}";
+    TPaths paths = { {"i"}, {"u"}, {"big"}, {"d"}, {"e"}, {"z"}, {"t"}, {"f"}, {"n"} };
+    CHECK_VALUE( extractJsonValues( doc, paths, values ), true )
+    CHECK_VALUE( values["i"].asInt64(), -42 )
+    CHECK_VALUE( values["u"].asUInt64(), 18446744073709551615ull )
+    CHECK_VALUE( values["big"].isDouble(), true )
+    CHECK_VALUE( values["d"].asDouble(), 0.25 )
+    CHECK_VALUE( values["e"].asDouble(), 0.01 )
+    CHECK_VALUE( values["z"].asInt(), 0 )
+    CHECK_VALUE( values["t"].asBool(), true )
+    CHECK_VALUE( values["f"].asBool(), false )
+    CHECK_VALUE( values.isMember( "n" ), true )
+    CHECK_VALUE( values["n"].isNull(), true )
+
+    // The result matches the values of the full parse
+    Json::Value full = parseJsonString( doc );
+    for( const auto& path: paths )
+        CHECK_VALUE( values[path[0]], full[path[0]] )
+    return 0;
+}
+
+// Missing paths are ignored, paths must match from the root and the scanner does not look into arrays
+int test_missing_path() {
+    Json::Value values;
+    CHECK_VALUE( extractJsonValues( "{\"metering\": {\"sessionId\": \"ABC\"}}", sLicensePaths, values ), true )
+    CHECK_VALUE( values["metering"]["sessionId"].asString(), "ABC" )
+    CHECK_VALUE( values.isMember( "license" ), false )
+
+    CHECK_VALUE( extractJsonValues( "{\"other\": {\"metering\": {\"sessionId\": \"ABC\"}}}", sLicensePaths, values ), true )
+    CHECK_VALUE( values.empty(), true )
+
+    CHECK_VALUE( extractJsonValues( "{\"metering\": [{\"sessionId\": \"ABC\"}]}", sLicensePaths, values ), true )
+    CHECK_VALUE( values.empty(), true )
+    CHECK_VALUE( extractJsonValues( "{\"list\": [{\"sessionId\": \"ABC\"}]}", { { "list", "sessionId" } }, values ), true )
+    CHECK_VALUE( values.empty(), true )
+
+    CHECK_VALUE( extractJsonValues( "[1, 2]", sLicensePaths, values ), true )
+    CHECK_VALUE( extractJsonValues( "\"text\"", sLicensePaths, values ), true )
+    CHECK_VALUE( values.empty(), true )
+    CHECK_VALUE( extractJsonValues( "{}", TPaths(), values ), true )
+    return 0;
+}
+
+// A requested path pointing to an object or an array is rejected: the caller parses the whole document
+int test_object_path() {
+    Json::Value values;
+    CHECK_VALUE( extractJsonValues( "{\"metering\": {\"sessionId\": {\"id\": \"ABC\"}}}", sLicensePaths, values ), false )
+    CHECK_VALUE( extractJsonValues( "{\"metering\": {\"sessionId\": [\"ABC\"]}}", sLicensePaths, values ), false )
+    CHECK_VALUE( extractJsonValues( "{\"metering\": {\"sessionId\": {}}}", sLicensePaths, values ), false )
+    CHECK_VALUE( extractJsonValues( "{\"metering\": \"ABC\"}", sLicensePaths, values ), true )
+    CHECK_VALUE( values.empty(), true )
+    return 0;
+}
+
+// Escaped keys match their decoded value, escaped values are decoded to UTF-8
+int test_escapes() {
+    Json::Value values;
+    string doc = "{\"a\\\"b\": \"q\\\"\\\\\\/\\b\\f\\n\\r\\t\","
+                 " \"\\u006beY\": \"\\u00e9\\u20AC\\ud83d\\ude00\","
+                 " \"skip\\u0041\": \"\\ud83d\\ude00 \\\" \\\\\"}";
+    TPaths paths = { { "a\"b" }, { "keY" }, { "skip" } };
+    CHECK_VALUE( extractJsonValues( doc, paths, values ), true )
+    CHECK_VALUE( values["a\"b"].asString(), "q\"\\/\b\f\n\r\t" )
+    CHECK_VALUE( values["keY"].asString(), "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80" )
+    CHECK_VALUE( values.isMember( "skip" ), false )
+    CHECK_VALUE( values["keY"], parseJsonString( doc )["keY"] )
+
+    // Invalid escapes are rejected in requested and skipped values
+    for( const string& value: vector<string>{ "\\x", "\\u12", "\\u12G4", "\\ud83d", "\\ud83dx",
+            "\\ud83d\\u0041", "\\ude00", "\\", "a\x01" } ) {
+        CHECK_MALFORMED( "{\"keY\": \"" + value + "\"}", paths )
+        CHECK_MALFORMED( "{\"other\": \"" + value + "\"}", paths )
+        CHECK_MALFORMED( "{\"" + value + "\": 1}", paths )
+    }
+    return 0;
+}
+
+// Malformed numbers and literals are rejected whether their value is requested or not
+int test_malformed() {
+    TPaths paths = { { "kept" } };
+    for( const string& value: vector<string>{ "1-2", "--1", "-", "+1", "01", "-01", "1.", ".5", "1.e3", "1e",
+            "1e+", "1E-", "0x10", "1.2.3", "1e2e3", "tru", "truee", "nul", "False", "NaN", "Infinity", "'a'" } ) {
+        CHECK_MALFORMED( "{\"kept\": " + value + "}", paths )
+        CHECK_MALFORMED( "{\"skipped\": " + value + "}", paths )
+        CHECK_MALFORMED( "{\"skipped\": [" + value + "]}", paths )
+    }
+    // Structure errors
+    for( const string& doc: vector<string>{ "", " ", "{", "}", "{\"kept\": }", "{\"kept\"}", "{\"a\" 1}",
+            "{\"a\": 1,}", "{\"a\": 1 \"b\": 2}", "{a: 1}", "[1, 2,]", "[1 2]", "{\"a\": 1}}", "{\"a\": 1} x",
+            "{\"a\": [1}", "{\"a\": {]}" } )
+        CHECK_MALFORMED( doc, paths )
+
+    // Nesting is limited
+    string deep = string( 100, '[' ) + string( 100, ']' );
+    CHECK_MALFORMED( deep, paths )
+    Json::Value values;
+    string shallow = string( 50, '[' ) + string( 50, ']' );
+    CHECK_VALUE( extractJsonValues( "{\"kept\": 1, \"a\": " + shallow + "}", paths, values ), true )
+    CHECK_VALUE( values["kept"].asInt(), 1 )
+    return 0;
+}
+
+// Each truncation of a valid document is rejected
+int test_truncated() {
+    string doc = "{\"metering\": {\"sessionId\": \"A\\u00e9C\", \"timeoutSecond\": -30.5e1},"
+                 " \"license\": {\"DNA\": {\"key\": \"0123\", \"licenseTimer\": true}, \"x\": [null, false]}}";
+    Json::Value values;
+    CHECK_VALUE( extractJsonValues( doc, sLicensePaths, values ), true )
+    CHECK_VALUE( values["metering"]["timeoutSecond"].asDouble(), -305.0 )
+    for( size_t length = 0; length < doc.size(); length++ )
+        CHECK_MALFORMED( doc.substr( 0, length ), sLicensePaths )
+    return 0;
+}
+
+
+int main( int argc, char **argv ) {
+    string test_name = ( argc > 1 ) ? string( argv[1] ) : string();
+    int ret = 0;
+
+    if ( test_name.empty() || ( test_name == "test_extract" ) )
+        ret |= test_extract();
+    if ( test_name.empty() || ( test_name == "test_missing_path" ) )
+        ret |= test_missing_path();
+    if ( test_name.empty() || ( test_name == "test_object_path" ) )
+        ret |= test_object_path();
+    if ( test_name.empty() || ( test_name == "test_escapes" ) )
+        ret |= test_escapes();
+    if ( test_name.empty() || ( test_name == "test_malformed" ) )
+        ret |= test_malformed();
+    if ( test_name.empty() || ( test_name == "test_truncated" ) )
+        ret |= test_truncated();
+
+    cout << ( ret ? "FAILED" : "PASSED" ) << endl;
+    return ret ? 1 : 0;
+}
@@ -416,6 +416,23 @@ def test_drm_manager_with_bad_configuration_file(accelize_drm, conf_json, cred_j
     assert err_code == accelize_drm.exceptions.DRMBadFormat.error_code
     print('Test settings is a wrong type: PASS')
 
+    # Test when retry policy is not supported
+    conf_json.reset()
+    conf_json['settings']['ws_retry_policy'] = 'unknown'
+    conf_json.save()
+    with pytest.raises(accelize_drm.exceptions.DRMBadArg) as excinfo:
+        accelize_drm.DrmManager(
+            conf_json.path,
+            cred_json.path,
+            driver.read_register_callback,
+            driver.write_register_callback,
+            async_cb.callback
+        )
+    assert "Unsupported retry policy 'unknown'" in str(excinfo.value)
+    err_code = async_handler.get_error_code(str(excinfo.value))
+    assert err_code == accelize_drm.exceptions.DRMBadArg.error_code
+    print('Test unsupported retry policy: PASS')
+
 
 def test_drm_manager_with_bad_credential_file(accelize_drm, conf_json, cred_json, async_handler):
 
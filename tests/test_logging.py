@@ -426,6 +426,74 @@ def test_log_file_parameters_modifiability(accelize_drm, conf_json, cred_json, a
     print('Test log service parameters modifiability from config: PASS')
 
 
+def test_file_async(accelize_drm, conf_json, cred_json, async_handler):
+    """Test asynchronous logging writes all messages before the DRM manager is destroyed"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+
+    log_path = realpath("./drmlib-%d.log" % getpid())
+    msg = 'This is asynchronous message #%d'
+    msg_regex = REGEX_FORMAT_LONG % r'This is asynchronous message #\d+'
+    msg_count = 1000
+
+    for policy in ('block', 'overrun_oldest'):
+        async_cb.reset()
+        if isfile(log_path):
+            remove(log_path)
+        conf_json.reset()
+        conf_json['settings']['log_verbosity'] = 6
+        conf_json['settings']['log_file_verbosity'] = 2
+        conf_json['settings']['log_file_format'] = LOG_FORMAT_LONG
+        conf_json['settings']['log_file_path'] = log_path
+        conf_json['settings']['log_file_type'] = 1
+        conf_json['settings']['log_async'] = True
+        conf_json['settings']['log_async_queue_size'] = 16
+        conf_json['settings']['log_async_overflow_policy'] = policy
+        conf_json.save()
+        try:
+            drm_manager = accelize_drm.DrmManager(
+                conf_json.path,
+                cred_json.path,
+                driver.read_register_callback,
+                driver.write_register_callback,
+                async_cb.callback
+            )
+            drm_manager.set(log_message_level=2)
+            for i in range(msg_count):
+                drm_manager.set(log_message=msg % i)
+            drm_manager.set(log_message_level=4)
+            drm_manager.set(log_message='Last message')
+            del drm_manager
+            gc.collect()
+            with open(log_path, 'rt') as f:
+                log_content = f.read()
+            hit_count = len(findall(msg_regex, log_content))
+            if policy == 'block':
+                assert hit_count == msg_count
+            else:
+                assert 0 < hit_count <= msg_count
+            assert search(REGEX_FORMAT_LONG % 'Last message', log_content)
+            async_cb.assert_NoError()
+        finally:
+            if isfile(log_path):
+                remove(log_path)
+
+    # Bad overflow policy
+    conf_json.reset()
+    conf_json['settings']['log_async'] = True
+    conf_json['settings']['log_async_overflow_policy'] = 'drop'
+    conf_json.save()
+    with pytest.raises(accelize_drm.exceptions.DRMBadArg) as excinfo:
+        accelize_drm.DrmManager(
+            conf_json.path,
+            cred_json.path,
+            driver.read_register_callback,
+            driver.write_register_callback,
+            async_cb.callback
+        )
+    assert "Unsupported log_async_overflow_policy 'drop'" in str(excinfo.value)
+
+
 ## TEST LOG SERVICE
 
 def test_service_path(accelize_drm, conf_json, cred_json, async_handler):
@@ -180,6 +180,11 @@ def test_nodelock_reuse_existing_license(accelize_drm, conf_json, cred_json, asy
         assert not drm_manager.get('license_status')
         assert drm_manager.get('drm_license_type') == 'Node-Locked'
         assert drm_manager.get('license_duration') == 0
+        # No Web Service client is created: the parameters which do not need it can still be read
+        assert drm_manager.get('ws_license_statistics')['response_codes'] == {}
+        dump = drm_manager.get('dump_all')
+        assert 'ws_license_statistics' in dump
+        assert 'token_string' not in dump
         activators[0].generate_coin(10)
         activators[0].check_coin(drm_manager.get('metered_data'))
         # Stop application
@@ -9,6 +9,7 @@ from os import remove, getpid
 from os.path import getsize, isfile, dirname, join, realpath
 from re import search, finditer, MULTILINE
 from time import sleep, time
+from threading import Timer
 from json import loads
 from datetime import datetime, timedelta
 
@@ -70,7 +71,14 @@ _PARAM_LIST = ['license_type',
                'trigger_async_callback',
                'bad_product_id',
                'bad_oauth2_token',
-               'log_message']
+               'log_message',
+               'ws_oauth2_statistics',
+               'ws_license_statistics',
+               'metrics',
+               'hw_snapshot',
+               'activators_status',
+               'metered_data_samples',
+               'thread_settings']
 
 
 def ordered_json(obj):
@@ -877,6 +885,48 @@ def test_c_unittests(accelize_drm, exec_func):
     assert exec_lib.asyncmsg is None
 
 
+@pytest.mark.aws
+@pytest.mark.on_2_fpga
+def test_c_unittests_drm_manager_group(accelize_drm, exec_func):
+    """Test a DRM manager group of 2 slots: activation, renewal, deactivation and error aggregation"""
+    driver0 = accelize_drm.pytest_fpga_driver[0]
+    driver1 = accelize_drm.pytest_fpga_driver[1]
+    exec_lib = exec_func.load('unittests', driver0._fpga_slot_id, driver1._fpga_slot_id)
+
+    exec_lib.run('test_drm_manager_group')
+    assert exec_lib.returncode == 0
+    assert 'Failed to activate 1 of 2 slots, first error on slot #1' in exec_lib.stdout
+    assert exec_lib.asyncmsg is None
+
+
+@pytest.mark.parametrize('test_name', ['test_insert', 'test_cancel', 'test_cascade', 'test_overflow',
+                                       'test_periodic'])
+def test_timer_wheel(test_name):
+    """Test the timer wheel of the scheduler with explicit time points"""
+    from subprocess import run, PIPE
+    exec_path = join(dirname(realpath(__file__)), 'timer_wheel_tests')
+    if not isfile(exec_path):
+        pytest.skip("No executable '%s' found: test skipped" % exec_path)
+    result = run([exec_path, test_name], stdout=PIPE, stderr=PIPE)
+    print(result.stdout.decode())
+    assert result.returncode == 0
+    assert 'PASSED' in result.stdout.decode()
+
+
+@pytest.mark.parametrize('test_name', ['test_extract', 'test_missing_path', 'test_object_path', 'test_escapes',
+                                       'test_malformed', 'test_truncated'])
+def test_json_extractor(test_name):
+    """Test the JSON scanner extracting the license response fields"""
+    from subprocess import run, PIPE
+    exec_path = join(dirname(realpath(__file__)), 'json_extractor_tests')
+    if not isfile(exec_path):
+        pytest.skip("No executable '%s' found: test skipped" % exec_path)
+    result = run([exec_path, test_name], stdout=PIPE, stderr=PIPE)
+    print(result.stdout.decode())
+    assert result.returncode == 0
+    assert 'PASSED' in result.stdout.decode()
+
+
 def test_parameter_key_modification_with_get_set(accelize_drm, conf_json, cred_json, async_handler,
                                                  ws_admin):
     """Test accesses to parameter"""
@@ -1107,6 +1157,39 @@ def test_parameter_key_modification_with_get_set(accelize_drm, conf_json, cred_j
     assert nb_lines > 10, 'Unexpected HW report content'
     print("Test parameter 'hw_report': PASS")
 
+    # Test parameter: hw_snapshot
+    hw_snapshot = drm_manager.get('hw_snapshot')
+    assert datetime.strptime(hw_snapshot['time'], '%Y-%m-%dT%H:%M:%S.%fZ')
+    pages = hw_snapshot['pages']
+    assert sorted(pages.keys()) == ['ctrlreg', 'licfile', 'mailbox', 'meteringfile', 'tracefile', 'vlnvfile']
+    assert len(pages['ctrlreg']) > 0
+    assert all(0 <= value <= 0xFFFFFFFF for registers in pages.values() for value in registers)
+    print("Test parameter 'hw_snapshot': PASS")
+
+    # Test parameter: activators_status
+    activators_status = drm_manager.get('activators_status')
+    assert len(activators_status['activators']) == drm_manager.get('num_activators')
+    assert [e['active'] for e in activators_status['activators']] == activators.get_status()
+    assert all(e['active'] == bool(e['status'] & 1) for e in activators_status['activators'])
+    assert activators_status['all_active'] == activators.is_activated()
+    assert activators_status['age_ms'] < 1000
+    print("Test parameter 'activators_status': PASS")
+
+    # Test parameter: thread_settings
+    orig_thread_settings = drm_manager.get('thread_settings')
+    assert orig_thread_settings['thread_name'] == 'drm_continuity'
+    assert orig_thread_settings['thread_cpu_affinity'] == []
+    drm_manager.set(thread_settings={'thread_name': 'drm_test', 'thread_cpu_affinity': [0], 'thread_nice': 5})
+    thread_settings = drm_manager.get('thread_settings')
+    assert thread_settings['thread_name'] == 'drm_test'
+    assert thread_settings['thread_cpu_affinity'] == [0]
+    assert thread_settings['thread_nice'] == 5
+    with pytest.raises(accelize_drm.exceptions.DRMBadArg):
+        drm_manager.set(thread_settings={'thread_sched_policy': 'unknown'})
+    assert drm_manager.get('thread_settings') == thread_settings
+    drm_manager.set(thread_settings=orig_thread_settings)
+    print("Test parameter 'thread_settings': PASS")
+
     # Test parameter: frequency_detection_threshold
     orig_freq_threhsold = drm_manager.get('frequency_detection_threshold')    # Save original threshold
     exp_freq_threhsold = orig_freq_threhsold * 2
@@ -1175,7 +1258,10 @@ def test_parameter_key_modification_with_get_set(accelize_drm, conf_json, cred_j
     # Test parameter: dump_all
     dump_param = drm_manager.get('dump_all')
     assert isinstance(dump_param, dict)
-    assert len(dump_param) == _PARAM_LIST.index('dump_all')
+    assert len(dump_param) == _PARAM_LIST.index('dump_all') + \
+        len(_PARAM_LIST) - _PARAM_LIST.index('log_message') - 3
+    assert 'hw_snapshot' not in dump_param
+    assert 'metered_data_samples' not in dump_param
     assert all(key in _PARAM_LIST for key in dump_param.keys())
     print("Test parameter 'dump_all': PASS")
 
@@ -2648,3 +2734,450 @@ def test_directory_creation(accelize_drm, conf_json, cred_json, async_handler):
     finally:
         if isdir(log_dir):
             rmtree(log_dir)
+
+
+def test_token_cache(accelize_drm, conf_json, cred_json, async_handler, tmpdir):
+    """Test the OAuth2 token is shared through the token cache"""
+    from os import stat
+    from stat import S_IMODE
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+    cache_dir = str(tmpdir.join('token_cache'))
+
+    conf_json.reset()
+    conf_json['settings']['token_cache_dir'] = cache_dir
+    conf_json.save()
+
+    token_list = list()
+    for i in range(2):
+        async_cb.reset()
+        drm_manager = accelize_drm.DrmManager(
+            conf_json.path,
+            cred_json.path,
+            driver.read_register_callback,
+            driver.write_register_callback,
+            async_cb.callback
+        )
+        drm_manager.activate()
+        try:
+            token_list.append(drm_manager.get('token_string'))
+            assert drm_manager.get('token_time_left') > 0
+        finally:
+            drm_manager.deactivate()
+        del drm_manager
+        gc.collect()
+        async_cb.assert_NoError()
+    assert token_list[0] == token_list[1]
+    cache_files = glob(join(cache_dir, 'token_*.json'))
+    assert len(cache_files) == 1
+    assert S_IMODE(stat(cache_files[0]).st_mode) == 0o600
+    print('Test token cache: PASS')
+
+
+def test_retry_with_mock_web_service(accelize_drm, conf_json, cred_json, async_handler, ws_mock):
+    """Test the retry mechanism against injected Web Service errors"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+
+    conf_json.reset()
+    conf_json['licensing']['url'] = ws_mock.url
+    conf_json['settings']['ws_retry_period_short'] = 1
+    conf_json['settings']['ws_request_timeout'] = 5
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        # All requests fail with a retryable error
+        ws_mock.config.update(error_rate=1.0, error_codes=[503], retry_after=2)
+        with pytest.raises(accelize_drm.exceptions.DRMWSError) as excinfo:
+            drm_manager.activate()
+        assert search(r'Timeout on Authentication request after \d+ attempts', str(excinfo.value))
+        # Retry-After is honored: at most 1 attempt every 2 seconds during 5 seconds
+        assert ws_mock.get_stats()['token']['requests'] <= 3
+
+        # Service is back
+        ws_mock.config.update(error_rate=0.0)
+        drm_manager.activate()
+        assert drm_manager.get('license_status')
+        drm_manager.deactivate()
+    finally:
+        del drm_manager
+        gc.collect()
+    async_cb.assert_NoError()
+    print('Test retry with mock web service: PASS')
+
+
+@pytest.mark.no_parallel
+def test_ws_request_statistics(accelize_drm, conf_json, cred_json, async_handler, ws_mock):
+    """Test the Web Service request latency histograms and retry counts"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+
+    conf_json.reset()
+    conf_json['licensing']['url'] = ws_mock.url
+    conf_json['settings']['ws_retry_period_short'] = 1
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        # First requests fail with a retryable error
+        ws_mock.config.update(latency=0.2, error_rate=1.0, error_codes=[503])
+        Timer(1.5, ws_mock.config.update, kwargs=dict(error_rate=0.0)).start()
+        drm_manager.activate()
+        drm_manager.deactivate()
+
+        oauth2_stats = drm_manager.get('ws_oauth2_statistics')
+        assert oauth2_stats['response_codes']['200'] == 1
+        assert oauth2_stats['total_time_ms']['count'] == sum(oauth2_stats['response_codes'].values())
+        license_stats = drm_manager.get('ws_license_statistics')
+        total = license_stats['total_time_ms']
+        assert total['count'] == sum(license_stats['response_codes'].values())
+        assert oauth2_stats['retries']['503'] == oauth2_stats['response_codes']['503'] >= 1
+        assert total['buckets']['+Inf'] == total['count']
+        assert total['buckets']['100'] == 0     # Mock latency is 200 ms
+        assert total['sum'] >= 200 * total['count']
+        # Server processing time dominates on a local mock
+        assert license_stats['ttfb_time_ms']['sum'] >= 200 * total['count']
+        assert 'ws_license_statistics' in drm_manager.get('dump_all')
+    finally:
+        del drm_manager
+        gc.collect()
+    async_cb.assert_NoError()
+    print('Test Web Service request statistics: PASS')
+
+
+@pytest.mark.no_parallel
+def test_async_deactivate_with_metering_journal(accelize_drm, conf_json, cred_json, async_handler,
+                                                ws_mock, tmpdir):
+    """Test the last metering of a session is journaled then uploaded in background"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+    journal_dir = str(tmpdir.join('metering_journal'))
+
+    conf_json.reset()
+    conf_json['licensing']['url'] = ws_mock.url
+    conf_json['settings']['metering_journal_dir'] = journal_dir
+    conf_json['settings']['ws_retry_period_short'] = 1
+    conf_json['settings']['ws_request_timeout'] = 3
+    conf_json.save()
+
+    def create_drm_manager():
+        return accelize_drm.DrmManager(
+            conf_json.path,
+            cred_json.path,
+            driver.read_register_callback,
+            driver.write_register_callback,
+            async_cb.callback
+        )
+
+    # Web Service is down when the session is stopped: deactivate does not wait for it
+    drm_manager = create_drm_manager()
+    try:
+        drm_manager.activate()
+        assert drm_manager.get('license_status')
+        ws_mock.config.update(latency=2.0, error_rate=1.0, error_codes=[503])
+        start = time()
+        drm_manager.deactivate()
+        assert time() - start < 1
+        assert not drm_manager.get('license_status')
+        assert len(glob(join(journal_dir, 'metering_*.json'))) == 1
+    finally:
+        del drm_manager
+        gc.collect()
+    assert len(glob(join(journal_dir, 'metering_*.json'))) == 1
+
+    # Next instance replays the journal
+    ws_mock.config.update(latency=0.0, error_rate=0.0)
+    license_count = ws_mock.get_stats()['license']['requests']
+    drm_manager = create_drm_manager()
+    try:
+        start = time()
+        while glob(join(journal_dir, 'metering_*.json')) and time() - start < 10:
+            sleep(0.5)
+        assert not glob(join(journal_dir, 'metering_*.json'))
+        assert ws_mock.get_stats()['license']['requests'] > license_count
+    finally:
+        del drm_manager
+        gc.collect()
+    async_cb.assert_NoError()
+    print('Test asynchronous deactivate with metering journal: PASS')
+
+
+def test_metrics(accelize_drm, conf_json, cred_json, async_handler, tmpdir):
+    """Test the metrics parameter and the Prometheus metrics file"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+    metrics_path = str(tmpdir.join('drm.prom'))
+
+    conf_json.reset()
+    conf_json['settings']['metrics_file_path'] = metrics_path
+    conf_json['settings']['metrics_file_period'] = 1
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        drm_manager.activate()
+        metrics = drm_manager.get('metrics')
+        assert metrics['drm_register_reads_total'] > 0
+        assert metrics['drm_register_writes_total'] > 0
+        assert 0 < metrics['drm_page_switches_total'] <= metrics['drm_register_writes_total']
+        assert metrics['drm_register_errors_total'] == 0
+        assert metrics['drm_licenses_installed_total'] >= 1
+        # The counter may expire slightly after the measured frequency predicts
+        assert metrics['drm_license_early_wakeups_total'] <= 1
+        assert 'drm_license_wakeup_delay_us' in metrics
+        assert metrics['drm_controller_lock_wait_us']['count'] > 0
+        assert metrics['drm_controller_lock_hold_us']['count'] > 0
+        lock_stats = metrics['drm_controller_lock']
+        assert lock_stats['max_recursion_depth'] >= 1
+        assert lock_stats['operations']['setLicense']['count'] >= 1
+        assert lock_stats['operations']['setLicense']['hold_total_us'] >= \
+            lock_stats['operations']['setLicense']['hold_max_us']
+        assert metrics['ws_license']['response_codes']['200'] >= 1
+        sleep(2)
+        with open(metrics_path) as f:
+            content = f.read()
+        assert search(r'^# TYPE drm_register_reads_total counter$', content, MULTILINE)
+        assert search(r'^drm_register_reads_total [1-9]\d*$', content, MULTILINE)
+        assert search(r'^drm_license_renewal_latency_ms_bucket\{le="\+Inf"\} \d+$', content, MULTILINE)
+        assert search(r'^drm_ws_requests_total\{ws="license",code="200"\} [1-9]\d*$', content, MULTILINE)
+        assert search(r'^drm_ws_request_duration_ms_count\{ws="oauth2",phase="total"\} [1-9]\d*$',
+                      content, MULTILINE)
+        assert search(r'^drm_controller_lock_hold_us_total\{operation="setLicense"\} \d+$', content, MULTILINE)
+        drm_manager.deactivate()
+        assert drm_manager.get('metrics')['drm_licenses_installed_total'] >= 1
+    finally:
+        del drm_manager
+        gc.collect()
+    async_cb.assert_NoError()
+    print('Test metrics: PASS')
+
+
+def test_event_log(accelize_drm, conf_json, cred_json, async_handler, tmpdir):
+    """Test the JSON lines event log of the session lifecycle"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+    event_log_path = str(tmpdir.join('events', 'drm_events.jsonl'))
+
+    conf_json.reset()
+    conf_json['settings']['event_log_path'] = event_log_path
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        drm_manager.activate()
+        session_id = drm_manager.get('session_id')
+        drm_manager.deactivate()
+        drm_manager.set(trigger_async_callback='Event log test')
+    finally:
+        del drm_manager
+        gc.collect()
+    assert async_cb.was_called
+    assert async_cb.errcode == accelize_drm.exceptions.DRMDebug.error_code
+
+    with open(event_log_path) as f:
+        events = [loads(line) for line in f.read().splitlines()]
+    names = [e['event'] for e in events]
+    for event in events:
+        assert datetime.strptime(event['time'], '%Y-%m-%dT%H:%M:%S.%fZ')
+        assert event['pid'] == getpid()
+    assert names.index('session_start') < names.index('session_stop')
+    assert names[-1] == 'async_error'
+    assert events[-1]['message'].endswith('Event log test')
+    installed = [e for e in events if e['event'] == 'license_installed']
+    assert installed[0]['license_number'] == 1
+    assert installed[0]['license_duration_s'] > 0
+    assert all(e['session'] == session_id for e in installed)
+    attempts = [e for e in events if e['event'] == 'ws_attempt']
+    assert any(e['ws'] == 'License' and e['outcome'] == 'success' and e['http_code'] == 200
+               for e in attempts)
+    assert all(e['latency_ms'] >= 0 for e in attempts if 'latency_ms' in e)
+    print('Test event log: PASS')
+
+
+def test_activators_status_cache(accelize_drm, conf_json, cred_json, async_handler):
+    """Test the activators status refreshed by the background thread"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+    activators = accelize_drm.pytest_fpga_activators[0]
+    activators.reset_coin()
+
+    conf_json.reset()
+    conf_json['settings']['activators_status_period'] = 200
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        assert not drm_manager.get('activators_status')['all_active']
+        drm_manager.activate()
+        sleep(1)
+        status = drm_manager.get('activators_status')
+        assert status['all_active']
+        assert status['all_active'] == activators.is_activated()
+        assert status['age_ms'] <= 400
+        drm_manager.deactivate()
+        sleep(1)
+        assert not drm_manager.get('activators_status')['all_active']
+    finally:
+        del drm_manager
+        gc.collect()
+    async_cb.assert_NoError()
+    print('Test activators status cache: PASS')
+
+
+def test_metered_data_sampling(accelize_drm, conf_json, cred_json, async_handler):
+    """Test the metered data samples taken by the background thread"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+    activators = accelize_drm.pytest_fpga_activators[0]
+    activators.reset_coin()
+
+    conf_json.reset()
+    conf_json['settings']['metered_data_sampling_period'] = 100
+    conf_json['settings']['metered_data_sampling_size'] = 5
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        drm_manager.activate()
+        drm_manager.get('metered_data_samples')    # Flush samples taken before the session
+        activators[0].generate_coin(10)
+        sleep(1)
+        samples = drm_manager.get('metered_data_samples')
+        assert len(samples['samples']) == 5
+        assert samples['dropped'] > 0
+        times = [datetime.strptime(e['time'], '%Y-%m-%dT%H:%M:%S.%fZ') for e in samples['samples']]
+        assert times == sorted(times)
+        activators[0].check_coin(samples['samples'][-1]['value'])
+        assert samples['samples'][-1]['value'] == drm_manager.get('metered_data')
+        assert drm_manager.get('metered_data_samples')['dropped'] == 0
+        drm_manager.deactivate()
+    finally:
+        del drm_manager
+        gc.collect()
+    async_cb.assert_NoError()
+    print('Test metered data sampling: PASS')
+
+
+def test_async_error_dispatch(accelize_drm, conf_json, cred_json):
+    """Test asynchronous errors are queued, coalesced and dropped without blocking the caller"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    messages = list()
+
+    def slow_callback(message):
+        sleep(0.5)
+        messages.append(message.decode() if isinstance(message, bytes) else message)
+
+    conf_json.reset()
+    conf_json['settings']['async_error_queue_size'] = 2
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        slow_callback
+    )
+    try:
+        drm_manager.set(trigger_async_callback='error 1')
+        sleep(0.1)  # The dispatcher thread is now blocked in the callback
+        start = datetime.now()
+        for message in ('error 2', 'error 2', 'error 2', 'error 3', 'error 4'):
+            drm_manager.set(trigger_async_callback=message)
+        assert (datetime.now() - start).total_seconds() < 0.5
+        sleep(2)
+        assert len(messages) == 3
+        assert 'error 1' in messages[0]
+        assert 'error 2' in messages[1] and '(occurred 3 times)' in messages[1]
+        assert 'error 3' in messages[2]
+        metrics = drm_manager.get('metrics')
+        assert metrics['drm_async_errors_coalesced_total'] == 2
+        assert metrics['drm_async_errors_dropped_total'] == 1
+    finally:
+        del drm_manager
+        gc.collect()
+    print('Test asynchronous error dispatch: PASS')
+
+
+def test_config_hot_reload(accelize_drm, conf_json, cred_json, async_handler):
+    """Test runtime settings of the configuration file are applied while a session is running"""
+    driver = accelize_drm.pytest_fpga_driver[0]
+    async_cb = async_handler.create()
+
+    conf_json.reset()
+    conf_json['settings']['config_watch_period'] = 100
+    conf_json['settings']['ws_retry_period_long'] = 60
+    conf_json['settings']['ws_retry_period_short'] = 2
+    conf_json['settings']['ws_request_timeout'] = 10
+    conf_json.save()
+
+    drm_manager = accelize_drm.DrmManager(
+        conf_json.path,
+        cred_json.path,
+        driver.read_register_callback,
+        driver.write_register_callback,
+        async_cb.callback
+    )
+    try:
+        drm_manager.activate()
+        # Runtime settings are applied, the others are kept
+        conf_json['settings']['ws_retry_period_long'] = 30
+        conf_json['settings']['ws_retry_period_short'] = 5
+        conf_json['settings']['ws_request_timeout'] = 20
+        conf_json['settings']['metrics_file_period'] = 123456
+        conf_json.save()
+        sleep(1)
+        assert drm_manager.get('ws_retry_period_long') == 30
+        assert drm_manager.get('ws_retry_period_short') == 5
+        assert drm_manager.get('ws_request_timeout') == 20
+        assert drm_manager.get('session_status')
+        # Invalid settings are not applied at all
+        conf_json['settings']['ws_retry_period_short'] = 40
+        conf_json['settings']['ws_request_timeout'] = 25
+        conf_json.save()
+        sleep(1)
+        assert drm_manager.get('ws_retry_period_short') == 5
+        assert drm_manager.get('ws_request_timeout') == 20
+        drm_manager.deactivate()
+        async_cb.assert_NoError()
+    finally:
+        del drm_manager
+        gc.collect()
+    print('Test configuration hot reload: PASS')
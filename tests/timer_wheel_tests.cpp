@@ -0,0 +1,206 @@
+/*  Deterministic tests of the timer wheel: time points are given explicitly, no clock is read. */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "timer_wheel.h"
+
+using namespace std;
+using namespace Accelize::DRM;
+
+typedef TimerWheel::TClock TClock;
+typedef std::chrono::milliseconds ms;
+
+static const TClock::time_point sStart = TClock::time_point() + std::chrono::hours( 1 );
+
+
+#define CHECK_VALUE(val, exp_val) if ((val) != (exp_val)) { \
+    cout << __FUNCTION__ << ", " << __LINE__ << " - ERROR - bad value: got " << (val) << " but expect " << (exp_val) << endl; \
+    return -1; }
+
+
+// Return the IDs of the timers expired at time
+static vector<TimerWheel::TTimerId> advance( TimerWheel& wheel, const TClock::time_point& time ) {
+    vector<TimerWheel::TTimer> expired;
+    wheel.advance( time, expired );
+    vector<TimerWheel::TTimerId> ids;
+    for( auto& timer: expired ) {
+        ids.push_back( timer.first );
+        timer.second();
+    }
+    return ids;
+}
+
+// Return the time at which the timer expires, following the wakeups as the scheduler does
+static TClock::time_point runUntil( TimerWheel& wheel, const TimerWheel::TTimerId& id, size_t max_steps = 1000 ) {
+    for( size_t step = 0; step < max_steps; step++ ) {
+        TClock::time_point wakeup = wheel.getNextWakeup();
+        if ( wakeup == TClock::time_point::max() )
+            break;
+        for( const auto& expired_id: advance( wheel, wakeup ) )
+            if ( expired_id == id )
+                return wakeup;
+    }
+    return TClock::time_point::max();
+}
+
+static long long toMs( const TClock::time_point& time ) {
+    return std::chrono::duration_cast<ms>( time - sStart ).count();
+}
+
+
+// Timers expire at their tick, in expiration then insertion order, never before
+int test_insert() {
+    TimerWheel wheel( ms( 1 ), sStart );
+    wheel.add( 1, sStart + ms( 5 ), []{} );
+    wheel.add( 2, sStart + ms( 2 ), []{} );
+    wheel.add( 3, sStart + ms( 5 ), []{} );
+    wheel.add( 4, sStart + std::chrono::microseconds( 2500 ), []{} );   // Rounded up to the next tick
+    CHECK_VALUE( wheel.size(), 4u )
+    CHECK_VALUE( toMs( wheel.getNextWakeup() ), 2 )
+
+    CHECK_VALUE( advance( wheel, sStart + ms( 1 ) ).size(), 0u )
+    vector<TimerWheel::TTimerId> ids = advance( wheel, sStart + ms( 2 ) );
+    CHECK_VALUE( ids.size(), 1u )
+    CHECK_VALUE( ids[0], 2u )
+    CHECK_VALUE( toMs( wheel.getNextWakeup() ), 3 )
+
+    ids = advance( wheel, sStart + ms( 10 ) );
+    CHECK_VALUE( ids.size(), 3u )
+    CHECK_VALUE( ids[0], 4u )
+    CHECK_VALUE( ids[1], 1u )
+    CHECK_VALUE( ids[2], 3u )
+    CHECK_VALUE( wheel.empty(), true )
+    CHECK_VALUE( ( wheel.getNextWakeup() == TClock::time_point::max() ), true )
+
+    // A timer in the past expires on the next advance
+    wheel.add( 5, sStart + ms( 1 ), []{} );
+    CHECK_VALUE( toMs( wheel.getNextWakeup() ), 10 )
+    ids = advance( wheel, sStart + ms( 10 ) );
+    CHECK_VALUE( ids.size(), 1u )
+    CHECK_VALUE( ids[0], 5u )
+    return 0;
+}
+
+// Removed timers never expire, whatever their level
+int test_cancel() {
+    TimerWheel wheel( ms( 1 ), sStart );
+    int runs = 0;
+    wheel.add( 1, sStart + ms( 10 ), [&runs]{ runs++; } );
+    wheel.add( 2, sStart + ms( 100 ), [&runs]{ runs++; } );
+    wheel.add( 3, sStart + ms( 10000 ), [&runs]{ runs++; } );
+    wheel.add( 4, sStart + ms( 20 ), [&runs]{ runs++; } );
+    CHECK_VALUE( wheel.remove( 1 ), true )
+    CHECK_VALUE( wheel.remove( 1 ), false )
+    CHECK_VALUE( wheel.remove( 2 ), true )
+    CHECK_VALUE( wheel.remove( 3 ), true )
+    CHECK_VALUE( wheel.size(), 1u )
+    CHECK_VALUE( toMs( wheel.getNextWakeup() ), 20 )
+
+    vector<TimerWheel::TTimerId> ids = advance( wheel, sStart + ms( 20000 ) );
+    CHECK_VALUE( ids.size(), 1u )
+    CHECK_VALUE( ids[0], 4u )
+    CHECK_VALUE( runs, 1 )
+    CHECK_VALUE( wheel.remove( 4 ), false )
+    return 0;
+}
+
+// Timers of the upper levels move down level by level and expire at their exact tick
+int test_cascade() {
+    const long long slots = TimerWheel::cSlots;
+    const vector<long long> delays = {
+        slots - 1, slots, slots + 1,                        // Level 0 and 1 boundary
+        3 * slots + 5,                                      // Level 1
+        slots * slots, 2 * slots * slots + 7,               // Level 2
+        5 * slots * slots * slots + 3 * slots + 1,          // Level 3
+    };
+    for( const long long& delay: delays ) {
+        TimerWheel wheel( ms( 1 ), sStart );
+        wheel.add( 1, sStart + ms( delay ), []{} );
+        // Advancing in one step cascades through all the levels
+        CHECK_VALUE( advance( wheel, sStart + ms( delay - 1 ) ).size(), 0u )
+        vector<TimerWheel::TTimerId> ids = advance( wheel, sStart + ms( delay ) );
+        CHECK_VALUE( ids.size(), 1u )
+
+        // Following the wakeups reaches the timer without expiring it early
+        TimerWheel wheel2( ms( 1 ), sStart );
+        wheel2.add( 1, sStart + ms( delay ), []{} );
+        CHECK_VALUE( toMs( runUntil( wheel2, 1 ) ), delay )
+    }
+
+    // Timers sharing an upper level slot expire in order
+    TimerWheel wheel( ms( 1 ), sStart );
+    wheel.add( 1, sStart + ms( 3 * slots + 9 ), []{} );
+    wheel.add( 2, sStart + ms( 3 * slots + 2 ), []{} );
+    CHECK_VALUE( toMs( runUntil( wheel, 2 ) ), 3 * slots + 2 )
+    CHECK_VALUE( toMs( runUntil( wheel, 1 ) ), 3 * slots + 9 )
+    return 0;
+}
+
+// Timers beyond the top level wait in the overflow list, then enter the wheel
+int test_overflow() {
+    const long long span = 1LL << ( TimerWheel::cSlotBits * TimerWheel::cLevels );
+    const vector<long long> delays = { span, span + 1000, 3 * span + 12345 };
+    for( const long long& delay: delays ) {
+        TimerWheel wheel( ms( 1 ), sStart );
+        wheel.add( 1, sStart + ms( delay ), []{} );
+        wheel.add( 2, sStart + ms( 10 ), []{} );
+        CHECK_VALUE( toMs( wheel.getNextWakeup() ), 10 )
+        CHECK_VALUE( advance( wheel, sStart + ms( delay - 1 ) ).size(), 1u )
+        vector<TimerWheel::TTimerId> ids = advance( wheel, sStart + ms( delay ) );
+        CHECK_VALUE( ids.size(), 1u )
+        CHECK_VALUE( ids[0], 1u )
+
+        TimerWheel wheel2( ms( 1 ), sStart );
+        wheel2.add( 1, sStart + ms( delay ), []{} );
+        CHECK_VALUE( toMs( runUntil( wheel2, 1 ) ), delay )
+        CHECK_VALUE( wheel2.empty(), true )
+    }
+    return 0;
+}
+
+// A periodic timer added again at each expiration, as the scheduler does, keeps its period
+int test_periodic() {
+    const long long period = 150;    // Not a multiple of the slot count: crosses level boundaries
+    TimerWheel wheel( ms( 1 ), sStart );
+    TClock::time_point next = sStart + ms( period );
+    wheel.add( 1, next, []{} );
+    wheel.add( 2, sStart + ms( 1000 ), []{} );
+    for( int run = 1; run <= 20; run++ ) {
+        TClock::time_point expiration = runUntil( wheel, 1 );
+        CHECK_VALUE( toMs( expiration ), run * period )
+        next += ms( period );
+        wheel.add( 1, next, []{} );
+    }
+    CHECK_VALUE( wheel.size(), 1u )
+
+    // A late run is not caught up: the next expiration is one period after the late advance
+    wheel.remove( 1 );
+    TClock::time_point late = next + ms( 3 * period + 20 );
+    advance( wheel, late );
+    wheel.add( 1, late + ms( period ), []{} );
+    CHECK_VALUE( toMs( runUntil( wheel, 1 ) ), toMs( late ) + period )
+    return 0;
+}
+
+
+int main( int argc, char **argv ) {
+    string test_name = ( argc > 1 ) ? string( argv[1] ) : string();
+    int ret = 0;
+
+    if ( test_name.empty() || ( test_name == "test_insert" ) )
+        ret |= test_insert();
+    if ( test_name.empty() || ( test_name == "test_cancel" ) )
+        ret |= test_cancel();
+    if ( test_name.empty() || ( test_name == "test_cascade" ) )
+        ret |= test_cascade();
+    if ( test_name.empty() || ( test_name == "test_overflow" ) )
+        ret |= test_overflow();
+    if ( test_name.empty() || ( test_name == "test_periodic" ) )
+        ret |= test_periodic();
+
+    cout << ( ret ? "FAILED" : "PASSED" ) << endl;
+    return ret ? 1 : 0;
+}
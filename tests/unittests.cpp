@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <getopt.h>
+#include <unistd.h>
+#include <vector>
 
 /* JsonCPP Library */
 #include <json/json.h>
@@ -416,6 +418,7 @@ public:
 /////////////////////////////////
 
 static DrmManagerMaker* sDrm = nullptr;
+static DrmManagerMaker* sDrm2 = nullptr;    // Second slot, for the tests of a DRM manager group
 
 
 // Test null callback pointers
@@ -687,6 +690,87 @@ int test_set_json_string_with_empty_string() {
 }
 
 
+// Test a DRM manager group of 2 slots: activation, license renewal and deactivation of all slots,
+// then the error reported when one of the slots fails
+int test_drm_manager_group() {
+    int ret = -1;
+    if (!sDrm2) {
+        cout << "A second slot must be specified to test a DRM manager group" << endl;
+        return ret;
+    }
+    static bool sFailSecondSlot = false;
+    vector<cpp::DrmManagerGroup::SlotCallbacks> slots;
+    for (DrmManagerMaker* maker: {sDrm, sDrm2}) {
+        pci_bar_handle_t* handle = &maker->pci_bar_handle;
+        bool is_second = (maker == sDrm2);
+        cpp::DrmManagerGroup::SlotCallbacks slot;
+        slot.read_register = [handle, is_second](uint32_t offset, uint32_t* p_value) {
+            if (is_second && sFailSecondSlot)
+                return 1;
+            return read_drm_register(offset, p_value, handle);
+        };
+        slot.write_register = [handle, is_second](uint32_t offset, uint32_t value) {
+            if (is_second && sFailSecondSlot)
+                return 1;
+            return write_drm_register(offset, value, handle);
+        };
+        slot.async_error = [](const string &msg) {
+            print_async_error(msg.c_str(), nullptr);
+        };
+        slots.push_back(slot);
+    }
+    try {
+        cpp::DrmManagerGroup group(sDrm->mConfFilePath, sDrm->mCredFilePath, slots);
+        CHECK_VALUE(group.size(), 2)
+
+        // Activate and renew the license of all slots
+        group.activate();
+        Json::Value installed[2];
+        for (size_t i = 0; i < group.size(); i++) {
+            CHECK_VALUE(group.getSlot(i).get<bool>(cpp::ParameterKey::license_status), true)
+            installed[i]["metrics"] = Json::nullValue;
+            group.getSlot(i).get(installed[i]);
+        }
+        uint32_t duration = group.getSlot(0).get<uint32_t>(cpp::ParameterKey::license_duration);
+        sleep(2 * duration + 2);
+        for (size_t i = 0; i < group.size(); i++) {
+            Json::Value metrics;
+            metrics["metrics"] = Json::nullValue;
+            group.getSlot(i).get(metrics);
+            uint64_t before = installed[i]["metrics"]["drm_licenses_installed_total"].asUInt64();
+            uint64_t after = metrics["metrics"]["drm_licenses_installed_total"].asUInt64();
+            if (after <= before) {
+                cout << __FUNCTION__ << " - ERROR - no license renewal on slot #" << i << endl;
+                return -1;
+            }
+            CHECK_VALUE(group.getSlot(i).get<bool>(cpp::ParameterKey::license_status), true)
+        }
+        group.deactivate();
+        for (size_t i = 0; i < group.size(); i++)
+            CHECK_VALUE(group.getSlot(i).get<bool>(cpp::ParameterKey::session_status), false)
+
+        // The first slot is still activated when the second one fails
+        sFailSecondSlot = true;
+        try {
+            group.activate();
+            cout << __FUNCTION__ << " - ERROR - activation of a failing slot succeeded" << endl;
+            return -1;
+        } catch( const cpp::Exception& e ) {
+            string msg = e.what();
+            cout << msg << endl;
+            CHECK_STRING(msg, "Failed to activate 1 of 2 slots, first error on slot #1")
+        }
+        CHECK_VALUE(group.getSlot(0).get<bool>(cpp::ParameterKey::license_status), true)
+        sFailSecondSlot = false;
+        group.deactivate();
+        ret = 0;
+    } catch( const cpp::Exception& e ) {
+        cout << "ERROR in " << __FUNCTION__ << ": " << e.what() << endl;
+        ret = e.getErrCode();
+    }
+    sFailSecondSlot = false;
+    return ret;
+}
 
 
 
@@ -702,6 +786,7 @@ void print_usage()
     cout << "   -f <path>  : Specify path to configuration file" << endl;
     cout << "   -d <path>  : Specify path to credential file" << endl;
     cout << "   -s <idx>   : If server has multiple board, specify the slot index of the targeted board" << endl;
+    cout << "   -S <idx>   : Specify the slot index of a second board, for the tests of a DRM manager group" << endl;
     cout << "   -t <name>  : Specify the name of test function to execute" << endl << endl;
     cout << "   -c         : When specified, the tests use the C API. Otherwise the C++ API is used" << endl;
 }
@@ -711,6 +796,7 @@ int main(int argc, char **argv) {
 
     string test_name;
     int slot_idx = 0;
+    int slot2_idx = -1;
     bool use_cpp = true;
     string conf_file_path, cred_file_path;
 
@@ -719,9 +805,10 @@ int main(int argc, char **argv) {
 
     // Retrieve the options:
     int opt;
-    while ( (opt = getopt(argc, argv, "hs:t:f:d:c")) != -1 ) {  // for each option...
+    while ( (opt = getopt(argc, argv, "hs:S:t:f:d:c")) != -1 ) {  // for each option...
         switch (opt) {
             case 's': slot_idx = atoi(optarg); break;
+            case 'S': slot2_idx = atoi(optarg); break;
             case 't': test_name = string(optarg); break;
             case 'f': conf_file_path = string(optarg); break;
             case 'd': cred_file_path = string(optarg); break;
@@ -754,6 +841,8 @@ int main(int argc, char **argv) {
         cout << "Running test: " << test_name << endl;*/
 
     sDrm = new DrmManagerMaker(slot_idx, use_cpp, conf_file_path, cred_file_path);
+    if (slot2_idx >= 0)
+        sDrm2 = new DrmManagerMaker(slot2_idx, use_cpp, conf_file_path, cred_file_path);
 
     int ret = 0;
 
@@ -789,6 +878,9 @@ int main(int argc, char **argv) {
         if (test_name == "test_set_json_string_with_empty_string")
             ret = test_set_json_string_with_empty_string();
 
+        if (test_name == "test_drm_manager_group")
+            ret = test_drm_manager_group();
+
     } catch( const cpp::Exception& e) {
         cerr << "Unexpected error: " << e.what() << endl;
         ret = -1;
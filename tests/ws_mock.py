@@ -0,0 +1,271 @@
+# -*- coding: utf-8 -*-
+"""
+Copyright 2019 Accelize
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+   http://www.apache.org/licenses/LICENSE-2.0
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+Local mock of the License Web Service.
+
+Implements the "/o/token/" and "/auth/metering/genlicense/" endpoints used by
+the DRM library with configurable latency, error codes and drop rates.
+
+Licenses must be signed by Accelize to be accepted by a DRM Controller: when an
+upstream URL is provided, license requests are forwarded to it and the mock only
+injects latency and faults. Without upstream, a well-formed license with a dummy
+key is returned: this is enough to test the client behavior (retry, timeouts,
+connections) but not to unlock a DRM Controller.
+
+Use "licensing.url" = "http://127.0.0.1:<port>" in the configuration file to
+select the mock.
+
+Run as a script:
+    python3 -m tests.ws_mock --port 8080 --latency 0.5 --error_rate 0.2 --error_codes 429,503
+
+The behavior can be changed at runtime by posting a JSON object with the same
+keys as MockConfig to "/mock/config". Statistics are available with a GET on
+"/mock/stats".
+"""
+import json
+from argparse import ArgumentParser
+from http.server import BaseHTTPRequestHandler, HTTPServer
+from random import random, choice
+from socketserver import ThreadingMixIn
+from threading import Lock, Thread
+from time import sleep, time
+from urllib.error import HTTPError
+from urllib.parse import parse_qs
+from urllib.request import Request, urlopen
+from uuid import uuid4
+
+
+class MockConfig(object):
+    """Mock behavior settings"""
+
+    def __init__(self, **kwargs):
+        self.latency = 0.0            # Delay in seconds before answering
+        self.error_rate = 0.0         # Probability to answer with an error code
+        self.error_codes = [503]      # Error codes picked randomly on error
+        self.drop_rate = 0.0          # Probability to close the connection without answer
+        self.retry_after = None       # Retry-After header value sent with 429 and 503 errors
+        self.token_validity = 3600    # OAuth2 token validity in seconds
+        self.license_duration = 60    # License duration in seconds ("timeoutSecond")
+        self.upstream = None          # Real License Web Service URL to forward requests to
+        self.update(**kwargs)
+
+    def update(self, **kwargs):
+        for key, value in kwargs.items():
+            if not hasattr(self, key):
+                raise KeyError('Unknown mock parameter: %s' % key)
+            setattr(self, key, value)
+
+    def to_dict(self):
+        return dict(self.__dict__)
+
+
+class _MockHandler(BaseHTTPRequestHandler):
+
+    protocol_version = 'HTTP/1.1'
+
+    def log_message(self, format, *args):
+        if self.server.verbose:
+            BaseHTTPRequestHandler.log_message(self, format, *args)
+
+    def _read_body(self):
+        length = int(self.headers.get('Content-Length', 0))
+        return self.rfile.read(length) if length else b''
+
+    def _send(self, code, content, headers=None):
+        body = json.dumps(content).encode() if not isinstance(content, bytes) else content
+        self.send_response(code)
+        self.send_header('Content-Type', 'application/json')
+        self.send_header('Content-Length', str(len(body)))
+        for key, value in (headers or dict()).items():
+            self.send_header(key, value)
+        self.end_headers()
+        self.wfile.write(body)
+
+    def _inject_faults(self, endpoint):
+        """Return True if the request has been answered with a fault"""
+        config = self.server.config
+        self.server.count(endpoint, 'requests')
+        if config.latency:
+            sleep(config.latency)
+        if random() < config.drop_rate:
+            self.server.count(endpoint, 'dropped')
+            self.close_connection = True
+            self.connection.close()
+            return True
+        if random() < config.error_rate:
+            code = choice(config.error_codes)
+            self.server.count(endpoint, str(code))
+            headers = dict()
+            if config.retry_after is not None and code in (429, 503):
+                headers['Retry-After'] = str(config.retry_after)
+            self._send(code, {'detail': 'Error %d injected by mock web service' % code}, headers)
+            return True
+        return False
+
+    def _forward(self, path, body):
+        request = Request(self.server.config.upstream + path, data=body, headers={
+            key: value for key, value in self.headers.items()
+            if key.lower() in ('authorization', 'content-type', 'accept')})
+        try:
+            with urlopen(request) as response:
+                return response.status, response.read()
+        except HTTPError as error:
+            return error.code, error.read()
+
+    def do_GET(self):
+        if self.path == '/mock/stats':
+            self._send(200, self.server.get_stats())
+        elif self.path == '/mock/config':
+            self._send(200, self.server.config.to_dict())
+        else:
+            self._send(404, {'detail': 'Not found'})
+
+    def do_POST(self):
+        body = self._read_body()
+        path = self.path.split('?')[0]
+        if path == '/mock/config':
+            try:
+                self.server.config.update(**json.loads(body.decode()))
+            except (KeyError, ValueError) as error:
+                self._send(400, {'detail': str(error)})
+                return
+            self._send(200, self.server.config.to_dict())
+        elif path == '/o/token/':
+            if self._inject_faults('token'):
+                return
+            if self.server.config.upstream:
+                self._send(*self._forward(path, body))
+                return
+            form = parse_qs(body.decode())
+            if 'client_id' not in form or 'client_secret' not in form:
+                self._send(401, {'error': 'invalid_client'})
+                return
+            self._send(200, {
+                'access_token': uuid4().hex,
+                'expires_in': self.server.config.token_validity,
+                'token_type': 'Bearer',
+                'scope': 'read write'})
+        elif path == '/auth/metering/genlicense/':
+            if self._inject_faults('license'):
+                return
+            if self.server.config.upstream:
+                self._send(*self._forward(path, body))
+                return
+            if not self.headers.get('Authorization', '').startswith('Bearer '):
+                self._send(401, {'detail': 'Authentication credentials were not provided.'})
+                return
+            try:
+                request = json.loads(body.decode())
+            except ValueError:
+                self._send(400, {'detail': 'Malformed request'})
+                return
+            self._send(200, self.server.build_license(request))
+        else:
+            self._send(404, {'detail': 'Not found'})
+
+
+class MockWebService(ThreadingMixIn, HTTPServer):
+    """Local License Web Service mock"""
+
+    daemon_threads = True
+
+    def __init__(self, port=0, host='127.0.0.1', verbose=False, **kwargs):
+        HTTPServer.__init__(self, (host, port), _MockHandler)
+        self.config = MockConfig(**kwargs)
+        self.verbose = verbose
+        self._stats = dict()
+        self._sessions = dict()
+        self._lock = Lock()
+        self._thread = None
+
+    @property
+    def url(self):
+        return 'http://%s:%d' % self.server_address
+
+    def count(self, endpoint, key):
+        with self._lock:
+            stats = self._stats.setdefault(endpoint, dict())
+            stats[key] = stats.get(key, 0) + 1
+
+    def get_stats(self):
+        with self._lock:
+            return json.loads(json.dumps(self._stats))
+
+    def build_license(self, request):
+        """Build a well-formed license response with a dummy key"""
+        with self._lock:
+            session_id = request.get('sessionId')
+            if request.get('request') == 'open' or not session_id:
+                session_id = '%016X' % (int(time() * 1000000) & 0xFFFFFFFFFFFFFFFF)
+            self._sessions[session_id] = request.get('request')
+        dna = request.get('dna', '')
+        return {
+            'metering': {
+                'sessionId': session_id,
+                'timeoutSecond': self.config.license_duration},
+            'license': {
+                dna: {
+                    'key': '0' * 64,
+                    'licenseTimer': '0' * 64}}}
+
+    def start(self):
+        self._thread = Thread(target=self.serve_forever, daemon=True)
+        self._thread.start()
+        return self
+
+    def stop(self):
+        self.shutdown()
+        self.server_close()
+        if self._thread is not None:
+            self._thread.join()
+
+
+def main():
+    parser = ArgumentParser(description='Local mock of the Accelize License Web Service')
+    parser.add_argument('--host', default='127.0.0.1')
+    parser.add_argument('--port', type=int, default=8080)
+    parser.add_argument('--latency', type=float, default=0.0,
+                        help='Delay in seconds before answering')
+    parser.add_argument('--error_rate', type=float, default=0.0,
+                        help='Probability to answer with an error code')
+    parser.add_argument('--error_codes', default='503',
+                        help='Comma separated list of error codes, for example: 429,500,470,560')
+    parser.add_argument('--drop_rate', type=float, default=0.0,
+                        help='Probability to close the connection without answer')
+    parser.add_argument('--retry_after', type=int, default=None,
+                        help='Retry-After value in seconds sent with 429 and 503 errors')
+    parser.add_argument('--license_duration', type=int, default=60)
+    parser.add_argument('--token_validity', type=int, default=3600)
+    parser.add_argument('--upstream', default=None,
+                        help='License Web Service URL to forward the requests to')
+    parser.add_argument('--verbose', action='store_true')
+    args = parser.parse_args()
+
+    server = MockWebService(
+        port=args.port, host=args.host, verbose=args.verbose,
+        latency=args.latency, error_rate=args.error_rate,
+        error_codes=[int(code) for code in args.error_codes.split(',')],
+        drop_rate=args.drop_rate, retry_after=args.retry_after,
+        license_duration=args.license_duration, token_validity=args.token_validity,
+        upstream=args.upstream)
+    print('Mock License Web Service listening on %s' % server.url)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    finally:
+        server.server_close()
+
+
+if __name__ == '__main__':
+    main()